@@ -0,0 +1,16 @@
+#!/bin/bash
+
+root_dir="$(pwd)/.."
+resources_dir="$root_dir/resources/"
+
+# Start benchmarking (first found instance of TrafficEZ)
+debug_file=$(find "$resources_dir" -type f -name "TrafficEZ-*" | head -n 1)
+
+if [ -n "$debug_file" ]; then
+    cd "$resources_dir"
+    echo "Benchmarking: $debug_file"
+    echo "=========="
+    "$debug_file" -b
+else
+    echo "File to benchmark not found."
+fi
\ No newline at end of file
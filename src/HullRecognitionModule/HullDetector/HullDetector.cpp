@@ -7,6 +7,9 @@ HullDetector::HullDetector(double minContourArea,
     : minContourArea(minContourArea)
     , startDetectionPercent(std::clamp(detectionStartPercent, 0, 100))
     , endDetectionPercent(std::clamp(detectionEndPercent, 0, 100))
+    , processingScale(1.0)
+    , componentLabelling(false)
+    , buildHullPoints(false)
     , startDetectionY(0)
     , endDetectionY(0)
 {}
@@ -20,6 +23,41 @@ void HullDetector::initDetectionBoundaries(const cv::Mat& frame) const
     calculateBoundaries(frame.rows);
 }
 
+/**
+ * @brief Sets the scale of the processed frames relative to the native
+ * stream resolution, so the pixel thresholds (given at native resolution)
+ * are scaled accordingly.
+ * @param scale see VideoStreamer::getProcessingScale.
+ */
+void HullDetector::setProcessingScale(double scale)
+{
+    processingScale = scale;
+}
+
+/**
+ * @brief Selects how getBlobs finds the blobs. Labelling gets the area,
+ * centroid and bounding box of every blob in one sweep over the frame,
+ * but the area is then the pixel count of the blob rather than the area
+ * of its convex hull, i.e. smaller for concave blobs, for the minimum
+ * area filter and the tracked area alike.
+ * @param enable true for connectedComponentsWithStats, false for the
+ * contours (the getHulls detection).
+ */
+void HullDetector::setComponentLabelling(bool enable)
+{
+    componentLabelling = enable;
+}
+
+/**
+ * @brief Selects if the labelled blobs get their convex hull points,
+ * only needed for drawing them. The contour blobs always have them.
+ * @param enable true to build the hull points of each labelled blob.
+ */
+void HullDetector::setBuildHullPoints(bool enable)
+{
+    buildHullPoints = enable;
+}
+
 /**
  * @brief Calculates the Y-axis boundaries for detection based on the frame height.
  * @param frameHeight The height of the frame used for detection.
@@ -36,45 +74,196 @@ void HullDetector::calculateBoundaries(int frameHeight) const
  * from the preprocessed frame.
  * @param frame the preprocessed frame.
  * @param hulls the hulls reference to store data.
+ * @param offset position of the frame in the initialized frame, e.g. the
+ * top left of getDetectionBand, the hulls are in initialized frame
+ * coordinates.
  */
 void HullDetector::getHulls(const cv::Mat& frame,
-                            std::vector<std::vector<cv::Point>>& hulls)
+                            std::vector<std::vector<cv::Point>>& hulls,
+                            const cv::Point& offset)
 {
-    if(frame.empty())
+    if(!isFrameValid(frame, "getHulls"))
+        return;
+
+    std::vector<HullBlob> blobs;
+    getContourBlobs(frame, blobs, offset);
+
+    hulls.clear();
+    for(auto& blob : blobs)
     {
-        std::cerr << "Error: Input frame is empty or invalid in getHulls\n";
+        hulls.push_back(std::move(blob.hullPoints));
+    }
+}
+
+/**
+ * @brief Gets the blobs of the preprocessed frame, with their area,
+ * centroid and bounding box, see setComponentLabelling.
+ * @param frame the preprocessed frame.
+ * @param blobs the blobs reference to store data.
+ * @param offset position of the frame in the initialized frame, the blobs
+ * are in initialized frame coordinates.
+ */
+void HullDetector::getBlobs(const cv::Mat& frame,
+                            std::vector<HullBlob>& blobs,
+                            const cv::Point& offset)
+{
+    blobs.clear(); // no stale blobs when reusing the vector
+    if(!isFrameValid(frame, "getBlobs"))
         return;
+
+    if(componentLabelling)
+    {
+        getComponentBlobs(frame, blobs, offset);
+    }
+    else
+    {
+        getContourBlobs(frame, blobs, offset);
+    }
+}
+
+/**
+ * @brief Checks the frame and the detection boundaries before detecting.
+ * @param frame the preprocessed frame.
+ * @param caller the method name for the error message.
+ * @return true if the detection can proceed.
+ */
+bool HullDetector::isFrameValid(const cv::Mat& frame, const char* caller) const
+{
+    if(frame.empty())
+    {
+        std::cerr << "Error: Input frame is empty or invalid in " << caller
+                  << "\n";
+        return false;
     }
 
     if(startDetectionY == 0 && endDetectionY == 0)
     {
         std::cerr << "Error: Please call initialize first\n";
-        return;
+        return false;
     }
 
+    return true;
+}
+
+/**
+ * @brief Gets the blobs from the contours, each simplified and then
+ * wrapped in its convex hull, the area and centroid are the hull's.
+ * @param frame the preprocessed frame.
+ * @param blobs the blobs reference to store data.
+ * @param offset position of the frame in the initialized frame.
+ */
+void HullDetector::getContourBlobs(const cv::Mat& frame,
+                                   std::vector<HullBlob>& blobs,
+                                   const cv::Point& offset) const
+{
+    double scaledMinArea = minContourArea * processingScale * processingScale;
+    double approxEpsilon = std::max(1.0, 5 * processingScale);
+
     std::vector<std::vector<cv::Point>> contours;
     cv::findContours(
-        frame, contours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE);
+        frame, contours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE, offset);
 
-    hulls.clear();
+    blobs.clear();
     for(const auto& contour : contours)
     {
         // Simplify the contour
         std::vector<cv::Point> approxContour;
-        cv::approxPolyDP(contour, approxContour, 5, true);
+        cv::approxPolyDP(contour, approxContour, approxEpsilon, true);
 
         cv::Moments mu = cv::moments(approxContour);
-        if(mu.m00 < minContourArea)
+        if(mu.m00 < scaledMinArea)
             continue; // filter small contours
 
         cv::Point2f centroid(mu.m10 / mu.m00, mu.m01 / mu.m00);
         if(centroid.y < startDetectionY || centroid.y > endDetectionY)
             continue; // filter contours outside bounds
 
-        std::vector<cv::Point> hull;
-        cv::convexHull(approxContour, hull);
-        hulls.push_back(hull);
+        HullBlob blob;
+        cv::convexHull(approxContour, blob.hullPoints);
+
+        cv::Moments hullMu = cv::moments(blob.hullPoints);
+        blob.area = static_cast<float>(hullMu.m00);
+        blob.centroid = (hullMu.m00 > 0) ? cv::Point2f(hullMu.m10 / hullMu.m00,
+                                                       hullMu.m01 / hullMu.m00)
+                                         : centroid;
+        blob.boundingBox = cv::boundingRect(blob.hullPoints);
+        blobs.push_back(std::move(blob));
+    }
+}
+
+/**
+ * @brief Gets the blobs in one labelling sweep, 8-connected, the area
+ * is the pixel count and the centroid the mean pixel position.
+ * @param frame the preprocessed frame.
+ * @param blobs the blobs reference to store data.
+ * @param offset position of the frame in the initialized frame.
+ */
+void HullDetector::getComponentBlobs(const cv::Mat& frame,
+                                     std::vector<HullBlob>& blobs,
+                                     const cv::Point& offset)
+{
+    double scaledMinArea = minContourArea * processingScale * processingScale;
+
+    int labelCount = cv::connectedComponentsWithStats(
+        frame, labels, stats, centroids, 8, CV_32S);
+
+    blobs.clear();
+    for(int label = 1; label < labelCount; ++label) // 0 is the background
+    {
+        const int* stat = stats.ptr<int>(label);
+        if(stat[cv::CC_STAT_AREA] < scaledMinArea)
+            continue; // filter small blobs
+
+        const double* center = centroids.ptr<double>(label);
+        cv::Point2f centroid(center[0] + offset.x, center[1] + offset.y);
+        if(centroid.y < startDetectionY || centroid.y > endDetectionY)
+            continue; // filter blobs outside bounds
+
+        HullBlob blob;
+        blob.area = static_cast<float>(stat[cv::CC_STAT_AREA]);
+        blob.centroid = centroid;
+        blob.boundingBox = cv::Rect(stat[cv::CC_STAT_LEFT] + offset.x,
+                                    stat[cv::CC_STAT_TOP] + offset.y,
+                                    stat[cv::CC_STAT_WIDTH],
+                                    stat[cv::CC_STAT_HEIGHT]);
+
+        if(buildHullPoints)
+        {
+            buildComponentHull(label, blob, offset);
+        }
+
+        blobs.push_back(std::move(blob));
+    }
+}
+
+/**
+ * @brief Builds the convex hull of a labelled blob, tracing only the
+ * pixels of its bounding box.
+ * @param label the blob label in the last labelling.
+ * @param blob the blob, with its bounding box set.
+ * @param offset position of the frame in the initialized frame.
+ */
+void HullDetector::buildComponentHull(int label,
+                                      HullBlob& blob,
+                                      const cv::Point& offset)
+{
+    cv::Rect box = blob.boundingBox - offset;
+    cv::compare(labels(box), label, blobMask, cv::CMP_EQ);
+
+    std::vector<std::vector<cv::Point>> contours;
+    cv::findContours(blobMask,
+                     contours,
+                     cv::RETR_EXTERNAL,
+                     cv::CHAIN_APPROX_SIMPLE,
+                     box.tl() + offset);
+
+    std::vector<cv::Point> points;
+    for(const auto& contour : contours)
+    {
+        points.insert(points.end(), contour.begin(), contour.end());
     }
+
+    cv::convexHull(points, blob.hullPoints);
 }
 
 /**
@@ -86,6 +275,30 @@ int HullDetector::getEndDetectionLine() const
     return endDetectionY;
 }
 
+/**
+ * @brief Gets the rows of the frame that can hold a detected hull, i.e.
+ * the detection boundaries plus a margin, for preprocessing only them.
+ * @param frameSize size of the frame used for initialization.
+ * @param marginRows rows kept above and below the boundaries, at least the
+ * vertical reach of the preprocessing kernels.
+ * @return the band over the full frame width, the whole frame if not
+ * initialized.
+ */
+cv::Rect HullDetector::getDetectionBand(const cv::Size& frameSize,
+                                        int marginRows) const
+{
+    if(startDetectionY == 0 && endDetectionY == 0)
+    {
+        std::cerr << "Error: Please call initialize first\n";
+        return cv::Rect(cv::Point(), frameSize);
+    }
+
+    int top = std::max(startDetectionY - marginRows, 0);
+    int bottom = std::min(endDetectionY + marginRows + 1, frameSize.height);
+
+    return cv::Rect(0, top, frameSize.width, std::max(bottom - top, 0));
+}
+
 /**
  * @brief Draws lines on the frame to indicate the start and end detection boundaries.
  * @param frame The frame on which the boundary lines will be drawn.
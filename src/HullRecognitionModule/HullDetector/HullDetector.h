@@ -1,10 +1,14 @@
 #ifndef HULLDETECTOR_H
 #define HULLDETECTOR_H
 
+#include "HullBlob.h"
 #include <opencv2/opencv.hpp>
 
 /**
  * @brief Class for detecting convex hulls.
+ * getBlobs returns the compact HullBlob records instead, either from the
+ * contours, or in one labelling sweep (setComponentLabelling) which skips
+ * the contour tracing, simplification and moments of every blob.
  * Optionally, you can specify in the constructor the following:
  * @param minContourArea contours less than this is ignored.
  * @param detectionStartPercent %height of the frame y-axis to start detecting.
@@ -18,10 +22,18 @@ public:
                  int detectionEndPercent = 70);
 
     void initDetectionBoundaries(const cv::Mat& frame) const;
+    void setProcessingScale(double scale);
+    void setComponentLabelling(bool enable);
+    void setBuildHullPoints(bool enable);
 
     void getHulls(const cv::Mat& frame,
-                  std::vector<std::vector<cv::Point>>& hulls);
+                  std::vector<std::vector<cv::Point>>& hulls,
+                  const cv::Point& offset = cv::Point());
+    void getBlobs(const cv::Mat& frame,
+                  std::vector<HullBlob>& blobs,
+                  const cv::Point& offset = cv::Point());
     int getEndDetectionLine() const;
+    cv::Rect getDetectionBand(const cv::Size& frameSize, int marginRows) const;
 
     void drawLengthBoundaries(cv::Mat& frame) const;
 
@@ -30,10 +42,28 @@ private:
     const int startDetectionPercent;
     const int endDetectionPercent;
 
+    double processingScale;
+    bool componentLabelling;
+    bool buildHullPoints;
+
     mutable int startDetectionY;
     mutable int endDetectionY;
 
+    // connectedComponentsWithStats outputs, reused across frames
+    cv::Mat labels;
+    cv::Mat stats;
+    cv::Mat centroids;
+    cv::Mat blobMask;
+
     void calculateBoundaries(int frameHeight) const;
+    bool isFrameValid(const cv::Mat& frame, const char* caller) const;
+    void getContourBlobs(const cv::Mat& frame,
+                         std::vector<HullBlob>& blobs,
+                         const cv::Point& offset) const;
+    void getComponentBlobs(const cv::Mat& frame,
+                           std::vector<HullBlob>& blobs,
+                           const cv::Point& offset);
+    void buildComponentHull(int label, HullBlob& blob, const cv::Point& offset);
 };
 
 #endif
@@ -0,0 +1,66 @@
+#include "BlobGrid.h"
+#include <algorithm>
+#include <cmath>
+
+BlobGrid::BlobGrid()
+    : cellSize(1.0)
+{}
+
+/**
+ * @brief Buckets the blobs of a frame by the cell of their centroid.
+ * @param blobs the blobs, indexed as in forEachNear.
+ * @param cellSize the cell side, at least the search radius.
+ */
+void BlobGrid::build(const std::vector<HullBlob>& blobs, double cellSize)
+{
+    // a hair larger, so the rounding of the division never puts a blob
+    // within the search radius two cells away
+    this->cellSize = std::max(cellSize, 1.0) * (1 + CELL_MARGIN);
+
+    entries.clear();
+    for(size_t i = 0; i < blobs.size(); ++i)
+    {
+        const cv::Point2f& centroid = blobs[i].centroid;
+        entries.emplace_back(
+            getCellKey(getCell(centroid.x), getCell(centroid.y)), i);
+    }
+
+    std::sort(entries.begin(), entries.end());
+}
+
+/**
+ * @brief Gets the cell of a coordinate along one axis.
+ * @param coordinate x or y, may be negative.
+ * @return the cell index.
+ */
+int64_t BlobGrid::getCell(double coordinate) const
+{
+    return static_cast<int64_t>(std::floor(coordinate / cellSize));
+}
+
+/**
+ * @brief Packs the cell indices into one sortable key.
+ * @param cellX the cell index along x.
+ * @param cellY the cell index along y.
+ * @return the cell key.
+ */
+uint64_t BlobGrid::getCellKey(int64_t cellX, int64_t cellY)
+{
+    return (static_cast<uint64_t>(static_cast<uint32_t>(cellX)) << 32) |
+           static_cast<uint32_t>(cellY);
+}
+
+/**
+ * @brief Finds the first entry of a cell.
+ * @param key the cell key.
+ * @return the first entry with the key, or the end if the cell is empty.
+ */
+std::vector<std::pair<uint64_t, size_t>>::const_iterator
+BlobGrid::findCell(uint64_t key) const
+{
+    auto entry = std::lower_bound(
+        entries.begin(), entries.end(), std::make_pair(key, size_t(0)));
+
+    return (entry != entries.end() && entry->first == key) ? entry
+                                                          : entries.end();
+}
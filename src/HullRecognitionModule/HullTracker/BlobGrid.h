@@ -0,0 +1,68 @@
+#ifndef BLOBGRID_H
+#define BLOBGRID_H
+
+#include "HullBlob.h"
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Uniform grid over the blob centroids of a frame, for finding
+ * the blobs near a point without comparing against all of them.
+ * With cells as large as the search radius, every blob within the
+ * radius is in the 3x3 cells around the point. The cells are not
+ * allocated, the blobs are sorted by cell key and a cell is a binary
+ * search, so the grid is unbounded and reuses its buffer across frames.
+ */
+class BlobGrid
+{
+public:
+    BlobGrid();
+
+    void build(const std::vector<HullBlob>& blobs, double cellSize);
+
+    /**
+     * @brief Visits the blobs of the 3x3 cells around a point, i.e. at
+     * least all the blobs within cellSize of it, in ascending index order
+     * within each cell.
+     * @param point the search center.
+     * @param visit called with the index of each blob in build.
+     */
+    template<typename Visit>
+    void forEachNear(const cv::Point2f& point, Visit&& visit) const
+    {
+        if(entries.empty())
+            return;
+
+        int64_t cellX = getCell(point.x);
+        int64_t cellY = getCell(point.y);
+
+        for(int64_t x = cellX - 1; x <= cellX + 1; ++x)
+        {
+            for(int64_t y = cellY - 1; y <= cellY + 1; ++y)
+            {
+                uint64_t key = getCellKey(x, y);
+                auto entry = findCell(key);
+                for(; entry != entries.end() && entry->first == key; ++entry)
+                {
+                    visit(entry->second);
+                }
+            }
+        }
+    }
+
+private:
+    static constexpr double CELL_MARGIN = 1e-6;
+
+    double cellSize;
+
+    // (cell key, blob index), sorted
+    std::vector<std::pair<uint64_t, size_t>> entries;
+
+    int64_t getCell(double coordinate) const;
+    static uint64_t getCellKey(int64_t cellX, int64_t cellY);
+    std::vector<std::pair<uint64_t, size_t>>::const_iterator findCell(
+        uint64_t key) const;
+};
+
+#endif
@@ -0,0 +1,21 @@
+#ifndef HULLBLOB_H
+#define HULLBLOB_H
+
+#include <opencv2/opencv.hpp>
+
+/**
+ * @brief Compact record of a detected blob, all the HullTracker needs,
+ * so the area and centroid are computed once, by the HullDetector.
+ * The hull points are optional, only needed for drawing the blob
+ * (see HullDetector::setBuildHullPoints), the bounding box is drawn
+ * instead when they are empty.
+ */
+struct HullBlob
+{
+    float area = 0;
+    cv::Point2f centroid;
+    cv::Rect boundingBox;
+    std::vector<cv::Point> hullPoints;
+};
+
+#endif
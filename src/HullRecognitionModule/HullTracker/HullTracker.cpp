@@ -1,7 +1,7 @@
 #include "HullTracker.h"
-#include <memory>
+#include <algorithm>
+#include <limits>
 #include <opencv2/opencv.hpp>
-#include <unordered_map>
 #include <vector>
 
 HullTracker::HullTracker(double maxDiffDistance,
@@ -14,14 +14,16 @@ HullTracker::HullTracker(double maxDiffDistance,
     , boundaryCushionPixels(boundaryCushionPixels)
     , maxFramesNotSeen(maxFramesNotSeen)
     , maxId(maxId)
+    , processingScale(1.0)
+    , matching(TrackMatching::FIRST_FIT)
+    , gridLookup(true)
     , currentId(0)
     , hullCount(0)
     , totalHullArea(0)
     , totalAverageSpeed(0)
     , boundaryLineY(0)
-{
-    trackedHulls.clear();
-}
+    , trackedHulls(maxId)
+{}
 
 /**
  * @brief Initializes the exit boundary line for hull tracking.
@@ -32,28 +34,92 @@ void HullTracker::initExitBoundaryLine(int lineY) const
     boundaryLineY = lineY;
 }
 
+/**
+ * @brief Sets the scale of the processed frames relative to the native
+ * stream resolution. The pixel thresholds are scaled to it, and the
+ * reported area and speed are converted back to native pixel units,
+ * so the traffic density does not depend on the processing resolution.
+ * @param scale see VideoStreamer::getProcessingScale.
+ */
+void HullTracker::setProcessingScale(double scale)
+{
+    processingScale = scale;
+}
+
+/**
+ * @brief Selects how the new blobs are matched with the trackables.
+ * The first fit depends on the iteration order of the tracked hulls,
+ * the global matching does not, and keeps the best pairs when several
+ * blobs are similar to a trackable, e.g. in congested lanes.
+ * @param matching see TrackMatching.
+ */
+void HullTracker::setMatching(TrackMatching matching)
+{
+    this->matching = matching;
+}
+
+/**
+ * @brief Selects how the trackables find their candidate blobs.
+ * Both give the same matches, the grid only compares the blobs near each
+ * trackable, so the matching stays near linear in congested lanes.
+ * @param enable true for the BlobGrid lookup, false to scan all the blobs.
+ */
+void HullTracker::setGridLookup(bool enable)
+{
+    gridLookup = enable;
+}
+
+/**
+ * @brief Selects if the tracked hulls keep the hull points of their
+ * blobs, only needed by drawTrackedHulls, the bounding boxes are drawn
+ * otherwise.
+ * @param enable true to keep the hull points.
+ */
+void HullTracker::setKeepHullPoints(bool enable)
+{
+    trackedHulls.setKeepHullPoints(enable);
+}
+
 /**
  * @brief Updates the tracked hulls with newly detected hulls.
  * @param newHulls New hull points to track and update.
  */
 void HullTracker::update(const std::vector<std::vector<cv::Point>>& newHulls)
 {
-    std::vector<bool> matched(newHulls.size(), false);
+    std::vector<HullBlob> newBlobs;
+    newBlobs.reserve(newHulls.size());
+    for(const auto& hull : newHulls)
+    {
+        newBlobs.push_back(computeBlob(hull));
+    }
+
+    update(newBlobs);
+}
+
+/**
+ * @brief Updates the tracked hulls with newly detected blobs,
+ * see HullDetector::getBlobs.
+ * @param newBlobs New blobs to track and update.
+ */
+void HullTracker::update(const std::vector<HullBlob>& newBlobs)
+{
+    std::vector<bool> matched(newBlobs.size(), false);
+    TrackableStore::Clock::time_point now = TrackableStore::Clock::now();
 
-    matchAndUpdateTrackables(newHulls, matched);
+    matchAndUpdateTrackables(newBlobs, matched);
 
     removeStaleTrackables();
-    processCrossedTrackables();
+    processCrossedTrackables(now);
 
-    createAndAddNewTrackables(newHulls, matched);
+    createAndAddNewTrackables(newBlobs, matched, now);
 }
 
 /**
  * @brief Retrieves the currently tracked hulls.
- * @return A map (dictionary) of tracked hulls keyed by their IDs.
+ * @return The store of the tracked hulls, see TrackableStore::findSlot
+ * for the lookup by ID.
  */
-const std::unordered_map<int, std::shared_ptr<HullTrackable>>&
-HullTracker::getTrackedHulls() const
+const TrackableStore& HullTracker::getTrackedHulls() const
 {
     return trackedHulls;
 }
@@ -73,7 +139,7 @@ int HullTracker::getHullCount() const
  */
 float HullTracker::getTotalHullArea() const
 {
-    return totalHullArea;
+    return totalHullArea / (processingScale * processingScale);
 }
 
 /**
@@ -82,7 +148,7 @@ float HullTracker::getTotalHullArea() const
  */
 float HullTracker::getAveragedSpeed() const
 {
-    return totalAverageSpeed / hullCount;
+    return totalAverageSpeed / hullCount / processingScale;
 }
 
 /**
@@ -99,67 +165,300 @@ void HullTracker::resetTrackerVariables()
 }
 
 /**
- * @brief Matches new hulls with existing tracked hulls and updates them.
- * @param newHulls New hulls detected in the current frame.
- * @param matched Vector (list) indicating which new hulls have been matched.
+ * @brief Matches new blobs with existing tracked hulls and updates them.
+ * @param newBlobs New blobs detected in the current frame.
+ * @param matched Vector (list) indicating which new blobs have been matched.
  */
 void HullTracker::matchAndUpdateTrackables(
-    const std::vector<std::vector<cv::Point>>& newHulls,
+    const std::vector<HullBlob>& newBlobs,
     std::vector<bool>& matched)
 {
-    for(auto& trackablePair : trackedHulls)
+    // cells as large as the match distance, the matches are in the 3x3
+    // cells around each trackable
+    if(gridLookup)
     {
-        auto& trackable = trackablePair.second;
-        float trackableArea = trackable->getHullArea();
-        bool isMatched = false;
+        blobGrid.build(newBlobs, maxDiffDistance * processingScale);
+    }
 
-        for(size_t i = 0; i < newHulls.size(); ++i)
-        {
-            if(matched[i])
-                continue;
+    if(matching == TrackMatching::GLOBAL)
+    {
+        matchGlobally(newBlobs, matched);
+        return;
+    }
 
-            float newHullArea = cv::contourArea(newHulls[i]);
-            float diffArea = std::abs(trackableArea - newHullArea);
+    for(size_t slot = 0; slot < trackedHulls.size(); ++slot)
+    {
+        float trackableArea = trackedHulls.getArea(slot);
+        cv::Point2f trackableCentroid = trackedHulls.getCentroid(slot);
+
+        // the lowest index, as a scan of all the blobs would find first
+        size_t matchIndex = newBlobs.size();
+        auto checkBlob = [&](size_t i) {
+            double cost = 0;
+            if(i < matchIndex && !matched[i] &&
+               getMatchCost(
+                   trackableArea, trackableCentroid, newBlobs[i], cost))
+            {
+                matchIndex = i;
+            }
+        };
 
-            // check if hull areas are similar within a threshold
-            if(diffArea / trackableArea > hullAreaThreshold)
-                continue;
+        if(gridLookup)
+        {
+            blobGrid.forEachNear(trackableCentroid, checkBlob);
+        }
+        else
+        {
+            for(size_t i = 0; i < matchIndex; ++i)
+            {
+                checkBlob(i);
+            }
+        }
 
-            // then check how far they are, i.e. Centroid Tracking
-            float diffDistance =
-                cv::norm(trackable->calculateCentroid() -
-                         HullTrackable::computeCentroid(newHulls[i]));
+        if(matchIndex < newBlobs.size())
+        {
+            setMatched(slot, newBlobs[matchIndex]);
+            matched[matchIndex] = true;
+        }
+        else
+        {
+            setNotMatched(slot);
+        }
+    }
+}
 
-            if(diffDistance < maxDiffDistance)
+/**
+ * @brief Matches new blobs with existing tracked hulls and updates them,
+ * with the minimum total cost over all the pairs. The pairs failing the
+ * area or distance check of the first fit are not allowed, the others
+ * cost their distance and area difference, both relative to the limits.
+ * @param newBlobs New blobs detected in the current frame.
+ * @param matched Vector (list) indicating which new blobs have been matched.
+ */
+void HullTracker::matchGlobally(const std::vector<HullBlob>& newBlobs,
+                                std::vector<bool>& matched)
+{
+    // by ID, so the result does not depend on the removal order
+    matchSlots.resize(trackedHulls.size());
+    for(size_t slot = 0; slot < matchSlots.size(); ++slot)
+    {
+        matchSlots[slot] = slot;
+    }
+    std::sort(matchSlots.begin(), matchSlots.end(), [this](size_t a, size_t b) {
+        return trackedHulls.getId(a) < trackedHulls.getId(b);
+    });
+
+    size_t rows = matchSlots.size();
+    size_t columns = newBlobs.size();
+    size_t size = std::max(rows, columns);
+    if(rows == 0)
+        return;
+
+    // an allowed pair costs less than 1 for the distance plus at most
+    // hullAreaThreshold for the area, so the not allowed cost is more than
+    // any sum of allowed pairs and the most pairs are matched
+    double maxAllowedCost = 1.0 + hullAreaThreshold;
+    double notAllowedCost = (maxAllowedCost + 1) * size + 1;
+    costMatrix.assign(size * size, notAllowedCost);
+
+    for(size_t row = 0; row < rows; ++row)
+    {
+        size_t slot = matchSlots[row];
+        float trackableArea = trackedHulls.getArea(slot);
+        cv::Point2f trackableCentroid = trackedHulls.getCentroid(slot);
+
+        auto setCost = [&](size_t column) {
+            double cost = 0;
+            if(getMatchCost(
+                   trackableArea, trackableCentroid, newBlobs[column], cost))
             {
-                trackable->setHullPoints(newHulls[i]);
-                trackable->setFramesSinceSeen(0);
+                costMatrix[row * size + column] = cost;
+            }
+        };
 
-                matched[i] = true;
-                isMatched = true;
-                break;
+        if(gridLookup)
+        {
+            blobGrid.forEachNear(trackableCentroid, setCost);
+        }
+        else
+        {
+            for(size_t column = 0; column < columns; ++column)
+            {
+                setCost(column);
             }
         }
+    }
+
+    solveAssignment(costMatrix, size, assignment);
 
-        // for the existing trackables that did not find a match in this loop
-        if(!isMatched)
+    for(size_t row = 0; row < rows; ++row)
+    {
+        size_t column = static_cast<size_t>(assignment[row]);
+
+        if(column < columns &&
+           costMatrix[row * size + column] < notAllowedCost)
+        {
+            setMatched(matchSlots[row], newBlobs[column]);
+            matched[column] = true;
+        }
+        else
         {
-            trackable->setFramesSinceSeen(trackable->getFramesSinceSeen() + 1);
+            setNotMatched(matchSlots[row]);
         }
     }
 }
 
 /**
- * @brief Creates and adds new trackables for hulls 
+ * @brief Updates a trackable with the blob it matched.
+ * @param slot The slot of the trackable.
+ * @param blob The matched blob.
+ */
+void HullTracker::setMatched(size_t slot, const HullBlob& blob)
+{
+    trackedHulls.update(slot, blob);
+    trackedHulls.setFramesSinceSeen(slot, 0);
+}
+
+/**
+ * @brief Counts one more frame for a trackable that did not find a match.
+ * @param slot The slot of the trackable.
+ */
+void HullTracker::setNotMatched(size_t slot)
+{
+    trackedHulls.setFramesSinceSeen(slot,
+                                    trackedHulls.getFramesSinceSeen(slot) + 1);
+}
+
+/**
+ * @brief Checks if a blob is similar enough to a trackable to match it:
+ * the areas within hullAreaThreshold, then the centroids closer than
+ * maxDiffDistance (Centroid Tracking).
+ * @param trackableArea The area of the trackable.
+ * @param trackableCentroid The centroid of the trackable.
+ * @param blob The new blob.
+ * @param cost Set to the distance and area difference of the pair, both
+ * relative to their limits, if they match.
+ * @return true if the blob can match the trackable.
+ */
+bool HullTracker::getMatchCost(float trackableArea,
+                               const cv::Point2f& trackableCentroid,
+                               const HullBlob& blob,
+                               double& cost) const
+{
+    float diffArea = std::abs(trackableArea - blob.area);
+    if(diffArea / trackableArea > hullAreaThreshold)
+        return false;
+
+    double maxDistance = maxDiffDistance * processingScale;
+    double diffDistance = cv::norm(trackableCentroid - blob.centroid);
+    if(diffDistance >= maxDistance)
+        return false;
+
+    cost = diffDistance / maxDistance + diffArea / trackableArea;
+    return true;
+}
+
+/**
+ * @brief Solves the square assignment problem with the Hungarian method
+ * (shortest augmenting paths with potentials), in O(size^3).
+ * @param costs Row major size x size cost matrix.
+ * @param size The number of rows and columns.
+ * @param rowToColumn The column assigned to each row.
+ */
+void HullTracker::solveAssignment(const std::vector<double>& costs,
+                                  size_t size,
+                                  std::vector<int>& rowToColumn)
+{
+    const double infinity = std::numeric_limits<double>::infinity();
+
+    // 1-based, row and column 0 are the virtual start of each path
+    std::vector<double> rowPotential(size + 1, 0);
+    std::vector<double> columnPotential(size + 1, 0);
+    std::vector<size_t> columnToRow(size + 1, 0);
+    std::vector<size_t> previousColumn(size + 1, 0);
+    std::vector<double> minSlack(size + 1);
+    std::vector<bool> visited(size + 1);
+
+    for(size_t row = 1; row <= size; ++row)
+    {
+        columnToRow[0] = row;
+        size_t column = 0;
+        std::fill(minSlack.begin(), minSlack.end(), infinity);
+        std::fill(visited.begin(), visited.end(), false);
+
+        // grow the path until it reaches a free column
+        do
+        {
+            visited[column] = true;
+            size_t pathRow = columnToRow[column];
+            double delta = infinity;
+            size_t nextColumn = 0;
+
+            for(size_t j = 1; j <= size; ++j)
+            {
+                if(visited[j])
+                    continue;
+
+                double slack = costs[(pathRow - 1) * size + (j - 1)] -
+                               rowPotential[pathRow] - columnPotential[j];
+                if(slack < minSlack[j])
+                {
+                    minSlack[j] = slack;
+                    previousColumn[j] = column;
+                }
+                if(minSlack[j] < delta)
+                {
+                    delta = minSlack[j];
+                    nextColumn = j;
+                }
+            }
+
+            for(size_t j = 0; j <= size; ++j)
+            {
+                if(visited[j])
+                {
+                    rowPotential[columnToRow[j]] += delta;
+                    columnPotential[j] -= delta;
+                }
+                else
+                {
+                    minSlack[j] -= delta;
+                }
+            }
+
+            column = nextColumn;
+        } while(columnToRow[column] != 0);
+
+        // flip the path
+        do
+        {
+            size_t pathColumn = previousColumn[column];
+            columnToRow[column] = columnToRow[pathColumn];
+            column = pathColumn;
+        } while(column != 0);
+    }
+
+    rowToColumn.assign(size, -1);
+    for(size_t j = 1; j <= size; ++j)
+    {
+        rowToColumn[columnToRow[j] - 1] = static_cast<int>(j - 1);
+    }
+}
+
+/**
+ * @brief Creates and adds new trackables for blobs 
  * that weren't matched with existing trackables.
- * @param newHulls New hulls detected in the current frame.
- * @param matched Vector (list) indicating which new hulls have been matched.
+ * @param newBlobs New blobs detected in the current frame.
+ * @param matched Vector (list) indicating which new blobs have been matched.
  */
 void HullTracker::createAndAddNewTrackables(
-    const std::vector<std::vector<cv::Point>>& newHulls,
-    const std::vector<bool>& matched)
+    const std::vector<HullBlob>& newBlobs,
+    const std::vector<bool>& matched,
+    TrackableStore::Clock::time_point now)
 {
-    for(size_t i = 0; i < newHulls.size(); ++i)
+    double exitLineY = boundaryLineY - boundaryCushionPixels * processingScale;
+
+    for(size_t i = 0; i < newBlobs.size(); ++i)
     {
         if(matched[i])
             continue;
@@ -171,13 +470,10 @@ void HullTracker::createAndAddNewTrackables(
         }
 
         // check if the hull is too near the boundary
-        cv::Point2f centroid = HullTrackable::computeCentroid(newHulls[i]);
-        if(centroid.y > boundaryLineY - boundaryCushionPixels)
+        if(newBlobs[i].centroid.y > exitLineY)
             continue;
 
-        auto newTrackable =
-            std::make_shared<HullTrackable>(currentId++, newHulls[i]);
-        trackedHulls[newTrackable->getTrackableId()] = newTrackable;
+        trackedHulls.add(currentId++, newBlobs[i], now);
     }
 }
 
@@ -185,33 +481,28 @@ void HullTracker::createAndAddNewTrackables(
  * @brief Processes hulls that have crossed the exit boundary.
  * That is, updating data needed to estimate traffic density
  * then removing them from the tracking list, indicating successful exit.
+ * @param now The current time, for the average speeds.
  */
-void HullTracker::processCrossedTrackables()
+void HullTracker::processCrossedTrackables(
+    TrackableStore::Clock::time_point now)
 {
-    std::vector<int> hullsToRemove;
+    double exitLineY = boundaryLineY - boundaryCushionPixels * processingScale;
 
-    for(const auto& trackablePair : trackedHulls)
+    // from the last slot, a removal moves the last trackable into the slot
+    for(size_t slot = trackedHulls.size(); slot-- > 0;)
     {
-        const auto& trackable = trackablePair.second;
-
         // when trackable exits the boundary line,
-        if(trackable->calculateCentroid().y >
-           boundaryLineY - boundaryCushionPixels)
+        if(trackedHulls.getCentroid(slot).y > exitLineY)
         {
             // update the following data
             hullCount++;
-            totalHullArea += trackable->getHullArea();
-            totalAverageSpeed += trackable->calculateAverageSpeed();
+            totalHullArea += trackedHulls.getArea(slot);
+            totalAverageSpeed += trackedHulls.getAverageSpeed(slot, now);
 
-            hullsToRemove.push_back(trackablePair.first);
+            // remove the exited hull from tracking list
+            trackedHulls.remove(slot);
         }
     }
-
-    // remove the exited hulls from tracking list
-    for(int id : hullsToRemove)
-    {
-        trackedHulls.erase(id);
-    }
 }
 
 /**
@@ -220,20 +511,13 @@ void HullTracker::processCrossedTrackables()
  */
 void HullTracker::removeStaleTrackables()
 {
-    std::vector<int> idsToRemove;
-
-    for(const auto& pair : trackedHulls)
+    for(size_t slot = trackedHulls.size(); slot-- > 0;)
     {
-        if(pair.second->getFramesSinceSeen() > maxFramesNotSeen)
+        if(trackedHulls.getFramesSinceSeen(slot) > maxFramesNotSeen)
         {
-            idsToRemove.push_back(pair.first);
+            trackedHulls.remove(slot);
         }
     }
-
-    for(int id : idsToRemove)
-    {
-        trackedHulls.erase(id);
-    }
 }
 
 /**
@@ -242,15 +526,26 @@ void HullTracker::removeStaleTrackables()
  */
 void HullTracker::drawTrackedHulls(cv::Mat& frame) const
 {
-    for(const auto& pair : trackedHulls)
+    for(size_t slot = 0; slot < trackedHulls.size(); ++slot)
     {
-        const auto& trackable = pair.second;
-        std::vector<std::vector<cv::Point>> hullVec = {
-            trackable->getHullPoints()};
-        cv::drawContours(frame, hullVec, -1, cv::Scalar(0, 255, 0), 2);
+        const std::vector<cv::Point>& hullPoints =
+            trackedHulls.getHullPoints(slot);
+        if(hullPoints.empty())
+        {
+            // the hull points were not built or not kept
+            cv::rectangle(frame,
+                          trackedHulls.getBoundingBox(slot),
+                          cv::Scalar(0, 255, 0),
+                          2);
+        }
+        else
+        {
+            std::vector<std::vector<cv::Point>> hullVec = {hullPoints};
+            cv::drawContours(frame, hullVec, -1, cv::Scalar(0, 255, 0), 2);
+        }
 
-        cv::Point2f idPos = trackable->calculateCentroid();
-        std::string idText = std::to_string(trackable->getTrackableId());
+        cv::Point2f idPos = trackedHulls.getCentroid(slot);
+        std::string idText = std::to_string(trackedHulls.getId(slot));
         cv::putText(frame,
                     idText,
                     idPos,
@@ -261,6 +556,28 @@ void HullTracker::drawTrackedHulls(cv::Mat& frame) const
     }
 }
 
+/**
+ * @brief Computes the blob record of a given hull,
+ * for the hulls of HullDetector::getHulls.
+ * @param hull The hull points.
+ * @return The blob, with the hull area, centroid and points.
+ */
+HullBlob HullTracker::computeBlob(const std::vector<cv::Point>& hull)
+{
+    HullBlob blob;
+    blob.hullPoints = hull;
+    if(hull.empty())
+        return blob;
+
+    cv::Moments moments = cv::moments(hull);
+    blob.area = static_cast<float>(moments.m00);
+    blob.centroid = cv::Point2f(static_cast<float>(moments.m10 / moments.m00),
+                                static_cast<float>(moments.m01 / moments.m00));
+    blob.boundingBox = cv::boundingRect(hull);
+
+    return blob;
+}
+
 /**
  * @brief Draws information about the lanes (only for debugging).
  * @param frame The frame on which the lane information will be drawn.
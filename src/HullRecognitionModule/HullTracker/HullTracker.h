@@ -1,7 +1,15 @@
 #ifndef HULLTRACKER_H
 #define HULLTRACKER_H
 
-#include "HullTrackable.h"
+#include "BlobGrid.h"
+#include "HullBlob.h"
+#include "TrackableStore.h"
+
+enum class TrackMatching
+{
+    FIRST_FIT, // each trackable takes the first similar blob
+    GLOBAL     // minimum cost assignment of all the trackables at once
+};
 
 /**
  * @brief Class for tracking convex hulls.
@@ -22,10 +30,14 @@ public:
                 int maxId = 1000);
 
     void initExitBoundaryLine(int lineY) const;
+    void setProcessingScale(double scale);
+    void setMatching(TrackMatching matching);
+    void setGridLookup(bool enable);
+    void setKeepHullPoints(bool enable);
     void update(const std::vector<std::vector<cv::Point>>& newHulls);
+    void update(const std::vector<HullBlob>& newBlobs);
 
-    const std::unordered_map<int, std::shared_ptr<HullTrackable>>&
-    getTrackedHulls() const;
+    const TrackableStore& getTrackedHulls() const;
 
     int getHullCount() const;
     float getTotalHullArea() const;
@@ -42,24 +54,48 @@ private:
     const int maxFramesNotSeen;
     const int maxId;
 
+    double processingScale;
+    TrackMatching matching;
+
+    // new blobs bucketed by centroid, for the candidates of a trackable
+    bool gridLookup;
+    BlobGrid blobGrid;
+
+    // global matching, reused across frames
+    std::vector<size_t> matchSlots;
+    std::vector<double> costMatrix;
+    std::vector<int> assignment;
+
     int currentId;
     int hullCount;
     float totalHullArea;
     float totalAverageSpeed;
 
     mutable int boundaryLineY;
-    std::unordered_map<int, std::shared_ptr<HullTrackable>> trackedHulls;
+    TrackableStore trackedHulls;
 
-    void matchAndUpdateTrackables(
-        const std::vector<std::vector<cv::Point>>& newHulls,
-        std::vector<bool>& matched);
+    void matchAndUpdateTrackables(const std::vector<HullBlob>& newBlobs,
+                                  std::vector<bool>& matched);
+    void matchGlobally(const std::vector<HullBlob>& newBlobs,
+                       std::vector<bool>& matched);
+    bool getMatchCost(float trackableArea,
+                      const cv::Point2f& trackableCentroid,
+                      const HullBlob& blob,
+                      double& cost) const;
+    static void solveAssignment(const std::vector<double>& costs,
+                                size_t size,
+                                std::vector<int>& rowToColumn);
+    void setMatched(size_t slot, const HullBlob& blob);
+    void setNotMatched(size_t slot);
 
-    void createAndAddNewTrackables(
-        const std::vector<std::vector<cv::Point>>& newHulls,
-        const std::vector<bool>& matched);
+    void createAndAddNewTrackables(const std::vector<HullBlob>& newBlobs,
+                                   const std::vector<bool>& matched,
+                                   TrackableStore::Clock::time_point now);
 
     void removeStaleTrackables();
-    void processCrossedTrackables();
+    void processCrossedTrackables(TrackableStore::Clock::time_point now);
+
+    static HullBlob computeBlob(const std::vector<cv::Point>& hull);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,248 @@
+#include "TrackableStore.h"
+#include <algorithm>
+#include <iostream>
+
+TrackableStore::TrackableStore(int maxId)
+    : keepHullPoints(false)
+    , slotById(std::max(maxId, 0) + 1, NO_SLOT)
+{}
+
+/**
+ * @brief Selects if the hull points of the blobs are stored, only
+ * needed for drawing the tracked hulls.
+ * @param enable true to keep the hull points.
+ */
+void TrackableStore::setKeepHullPoints(bool enable)
+{
+    keepHullPoints = enable;
+    if(!keepHullPoints)
+    {
+        for(auto& points : hullPoints)
+        {
+            points.clear();
+        }
+    }
+}
+
+/**
+ * @brief Removes all the trackables, the arrays keep their capacity.
+ */
+void TrackableStore::clear()
+{
+    ids.clear();
+    centroids.clear();
+    areas.clear();
+    boundingBoxes.clear();
+    startPoints.clear();
+    startTimes.clear();
+    framesSinceSeen.clear();
+    hullPoints.clear();
+
+    std::fill(slotById.begin(), slotById.end(), NO_SLOT);
+}
+
+/**
+ * @brief Adds a trackable at the end of the arrays. A trackable still
+ * holding the same ID (after the IDs wrapped around) is replaced.
+ * @param id The ID of the trackable, in [0, maxId].
+ * @param blob The blob the trackable starts from.
+ * @param now The time tracking starts, for the average speed.
+ * @return The slot of the new trackable, NO_SLOT if the ID is invalid.
+ */
+size_t TrackableStore::add(int id, const HullBlob& blob, Clock::time_point now)
+{
+    if(id < 0 || static_cast<size_t>(id) >= slotById.size())
+    {
+        std::cerr << "Error: Trackable ID " << id << " out of range.\n";
+        return NO_SLOT;
+    }
+
+    if(slotById[id] != NO_SLOT)
+    {
+        remove(slotById[id]);
+    }
+
+    size_t slot = ids.size();
+    ids.push_back(id);
+    centroids.push_back(blob.centroid);
+    areas.push_back(blob.area);
+    boundingBoxes.push_back(blob.boundingBox);
+    startPoints.push_back(blob.centroid);
+    startTimes.push_back(now);
+    framesSinceSeen.push_back(0);
+    hullPoints.emplace_back();
+    if(keepHullPoints)
+    {
+        hullPoints.back() = blob.hullPoints;
+    }
+
+    slotById[id] = slot;
+    return slot;
+}
+
+/**
+ * @brief Updates a trackable with the blob it matched in this frame.
+ * @param slot The slot of the trackable.
+ * @param blob The matched blob.
+ */
+void TrackableStore::update(size_t slot, const HullBlob& blob)
+{
+    centroids[slot] = blob.centroid;
+    areas[slot] = blob.area;
+    boundingBoxes[slot] = blob.boundingBox;
+    if(keepHullPoints)
+    {
+        hullPoints[slot] = blob.hullPoints;
+    }
+}
+
+/**
+ * @brief Removes a trackable, moving the last one into its slot,
+ * so removing while iterating should go from the last slot down.
+ * @param slot The slot of the trackable.
+ */
+void TrackableStore::remove(size_t slot)
+{
+    size_t last = ids.size() - 1;
+    slotById[ids[slot]] = NO_SLOT;
+
+    if(slot != last)
+    {
+        ids[slot] = ids[last];
+        centroids[slot] = centroids[last];
+        areas[slot] = areas[last];
+        boundingBoxes[slot] = boundingBoxes[last];
+        startPoints[slot] = startPoints[last];
+        startTimes[slot] = startTimes[last];
+        framesSinceSeen[slot] = framesSinceSeen[last];
+        hullPoints[slot].swap(hullPoints[last]);
+
+        slotById[ids[slot]] = slot;
+    }
+
+    ids.pop_back();
+    centroids.pop_back();
+    areas.pop_back();
+    boundingBoxes.pop_back();
+    startPoints.pop_back();
+    startTimes.pop_back();
+    framesSinceSeen.pop_back();
+    hullPoints.pop_back();
+}
+
+/**
+ * @brief Gets the number of trackables.
+ * @return The number of slots in use.
+ */
+size_t TrackableStore::size() const
+{
+    return ids.size();
+}
+
+/**
+ * @brief Checks if no hull is tracked.
+ * @return true if there are no trackables.
+ */
+bool TrackableStore::empty() const
+{
+    return ids.empty();
+}
+
+/**
+ * @brief Finds the current slot of a trackable.
+ * @param id The ID of the trackable.
+ * @return The slot, NO_SLOT if the ID is not tracked.
+ */
+size_t TrackableStore::findSlot(int id) const
+{
+    if(id < 0 || static_cast<size_t>(id) >= slotById.size())
+        return NO_SLOT;
+
+    return slotById[id];
+}
+
+/**
+ * @brief Gets the ID of a trackable.
+ * @param slot The slot of the trackable.
+ * @return The ID of the trackable.
+ */
+int TrackableStore::getId(size_t slot) const
+{
+    return ids[slot];
+}
+
+/**
+ * @brief Gets the area of a trackable.
+ * @param slot The slot of the trackable.
+ * @return The area of its last blob.
+ */
+float TrackableStore::getArea(size_t slot) const
+{
+    return areas[slot];
+}
+
+/**
+ * @brief Gets the centroid of a trackable.
+ * @param slot The slot of the trackable.
+ * @return The centroid of its last blob.
+ */
+const cv::Point2f& TrackableStore::getCentroid(size_t slot) const
+{
+    return centroids[slot];
+}
+
+/**
+ * @brief Gets the bounding box of a trackable.
+ * @param slot The slot of the trackable.
+ * @return The bounding box of its last blob.
+ */
+const cv::Rect& TrackableStore::getBoundingBox(size_t slot) const
+{
+    return boundingBoxes[slot];
+}
+
+/**
+ * @brief Gets the hull points of a trackable.
+ * @param slot The slot of the trackable.
+ * @return The hull points of its last blob, empty if not kept or not
+ * built by the detector.
+ */
+const std::vector<cv::Point>& TrackableStore::getHullPoints(size_t slot) const
+{
+    return hullPoints[slot];
+}
+
+/**
+ * @brief Gets the number of frames since the trackable was last seen.
+ * @param slot The slot of the trackable.
+ * @return The number of frames since last seen.
+ */
+int TrackableStore::getFramesSinceSeen(size_t slot) const
+{
+    return framesSinceSeen[slot];
+}
+
+/**
+ * @brief Sets the number of frames since the trackable was last seen.
+ * @param slot The slot of the trackable.
+ * @param frames The number of frames the trackable was untracked.
+ */
+void TrackableStore::setFramesSinceSeen(size_t slot, int frames)
+{
+    framesSinceSeen[slot] = frames;
+}
+
+/**
+ * @brief Calculates the average speed of a trackable, from where and
+ * when its tracking started to its current centroid.
+ * @param slot The slot of the trackable.
+ * @param now The current time.
+ * @return The average speed, in pixels/second.
+ */
+float TrackableStore::getAverageSpeed(size_t slot, Clock::time_point now) const
+{
+    float travelTime =
+        std::chrono::duration<float>(now - startTimes[slot]).count();
+
+    return cv::norm(startPoints[slot] - centroids[slot]) / travelTime;
+}
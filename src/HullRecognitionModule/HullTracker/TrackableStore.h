@@ -0,0 +1,62 @@
+#ifndef TRACKABLESTORE_H
+#define TRACKABLESTORE_H
+
+#include "HullBlob.h"
+#include <chrono>
+#include <vector>
+
+/**
+ * @brief Contiguous storage of the tracked hulls, one array per field
+ * (struct of arrays), so the matching loops read only the centroids and
+ * areas, and a new trackable does not allocate once the arrays are grown.
+ * The slots are dense and change when a trackable is removed (swap with
+ * the last one), the trackable IDs are stable, see findSlot.
+ * The hull points are only kept if enabled, for drawing.
+ * @param maxId Maximum ID value of the trackables.
+ */
+class TrackableStore
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr size_t NO_SLOT = static_cast<size_t>(-1);
+
+    explicit TrackableStore(int maxId);
+
+    void setKeepHullPoints(bool enable);
+    void clear();
+
+    size_t add(int id, const HullBlob& blob, Clock::time_point now);
+    void update(size_t slot, const HullBlob& blob);
+    void remove(size_t slot);
+
+    size_t size() const;
+    bool empty() const;
+    size_t findSlot(int id) const;
+
+    int getId(size_t slot) const;
+    float getArea(size_t slot) const;
+    const cv::Point2f& getCentroid(size_t slot) const;
+    const cv::Rect& getBoundingBox(size_t slot) const;
+    const std::vector<cv::Point>& getHullPoints(size_t slot) const;
+    int getFramesSinceSeen(size_t slot) const;
+    void setFramesSinceSeen(size_t slot, int frames);
+    float getAverageSpeed(size_t slot, Clock::time_point now) const;
+
+private:
+    bool keepHullPoints;
+
+    std::vector<int> ids;
+    std::vector<cv::Point2f> centroids;
+    std::vector<float> areas;
+    std::vector<cv::Rect> boundingBoxes;
+    std::vector<cv::Point2f> startPoints;
+    std::vector<Clock::time_point> startTimes;
+    std::vector<int> framesSinceSeen;
+    std::vector<std::vector<cv::Point>> hullPoints;
+
+    // slot of each ID, NO_SLOT if not tracked
+    std::vector<size_t> slotById;
+};
+
+#endif
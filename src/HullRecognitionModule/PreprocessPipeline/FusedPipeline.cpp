@@ -0,0 +1,566 @@
+#include "FusedPipeline.h"
+#include <algorithm>
+
+FusedPipeline::FusedPipeline()
+    : cacheBudget(DEFAULT_CACHE_BUDGET)
+    , parallelMode(false)
+    , timings(nullptr)
+    , preparedType(-1)
+{}
+
+/**
+ * @brief Builds the execution plan from the steps of a builder.
+ * The steps are created anew from the builder's current parameters,
+ * so later changes to the builder need another compile.
+ * @param builder The builder holding the steps, e.g. after
+ * PipelineDirector::loadPipelineConfig.
+ */
+void FusedPipeline::compile(const PipelineBuilder& builder)
+{
+    stages.clear();
+    stageFrames.clear();
+    preparedSize = cv::Size();
+    preparedType = -1;
+
+    for(size_t i = 0; i < builder.getNumberOfSteps(); ++i)
+    {
+        StepType type = builder.getStepType(i);
+        auto step = StepFactory::createStep(
+            type, builder.getStepCurrentParameters(i));
+        if(step == nullptr)
+        {
+            std::cerr << "Error: Unable to compile step " << i << " ("
+                      << StepFactory::stepTypeToString(type) << ").\n";
+            continue;
+        }
+
+        bool isBanded = isBandStep(*step);
+        if(stages.empty() || !isBanded || !stages.back().isBanded)
+        {
+            stages.emplace_back();
+            stages.back().isBanded = isBanded;
+        }
+
+        Stage& stage = stages.back();
+        if(isBanded)
+        {
+            stage.haloRows += getHaloRows(step->getCurrentParameters());
+        }
+        stage.steps.emplace_back(std::move(step));
+    }
+}
+
+/**
+ * @brief Runs the compiled plan, same result as PipelineBuilder::process.
+ * The stage buffers are sized on the first frame and then reused,
+ * so frames of a constant size and type do not allocate.
+ * @param input The image frame to be processed, left unchanged.
+ * @param output The processed frame.
+ */
+void FusedPipeline::process(const cv::Mat& input, cv::Mat& output)
+{
+    if(stages.empty())
+    {
+        input.copyTo(output);
+        return;
+    }
+
+    prepare(input);
+
+    const cv::Mat* stageInput = &input;
+    for(size_t i = 0; i < stages.size(); ++i)
+    {
+        cv::Mat& stageOutput =
+            (i + 1 == stages.size()) ? output : stageFrames[i];
+
+        processStage(stages[i], *stageInput, stageOutput);
+        stageInput = &stageOutput;
+    }
+}
+
+/**
+ * @brief Sets how many bytes a band of a fused stage may use,
+ * all the step buffers of the band included. Should fit the L2 cache.
+ * @param bytes The per-band memory budget.
+ */
+void FusedPipeline::setCacheBudget(size_t bytes)
+{
+    cacheBudget = bytes;
+    preparedSize = cv::Size(); // recompute the band heights
+}
+
+/**
+ * @brief Enables the parallel mode: the bands of the fused stages are
+ * processed across the cores (cv::getNumThreads), and the background
+ * models are split in as many row bands, each with its own model.
+ * Switching mode restarts the background models.
+ * @param enable true to process in parallel, false to process serially.
+ */
+void FusedPipeline::setParallel(bool enable)
+{
+    if(enable == parallelMode)
+        return;
+
+    parallelMode = enable;
+    preparedSize = cv::Size(); // resize the band buffer sets
+
+    for(auto& stage : stages)
+    {
+        stage.partitionSteps.clear();
+
+        // the full frame model missed the frames of the parallel mode
+        if(!stage.isBanded && isPartitionStep(*stage.steps.front()))
+        {
+            const auto& step = stage.steps.front();
+            stage.steps.front() = StepFactory::createStep(
+                step->getType(), step->getCurrentParameters());
+        }
+    }
+}
+
+/**
+ * @brief Records the duration of every step per StepType, see the
+ * class description for the fused and split steps.
+ * @param timings The histograms to record into, owned by the caller,
+ * nullptr to stop recording.
+ */
+void FusedPipeline::setTimings(StepTimings* timings)
+{
+    this->timings = timings;
+}
+
+/**
+ * @brief Checks if the parallel mode is enabled.
+ * @return true if the plan is processed across the cores.
+ */
+bool FusedPipeline::isParallel() const
+{
+    return parallelMode;
+}
+
+/**
+ * @brief Gets the number of stages of the compiled plan.
+ * @return The stage count, a fused run of steps counts as one.
+ */
+size_t FusedPipeline::getNumberOfStages() const
+{
+    return stages.size();
+}
+
+/**
+ * @brief Describes the compiled plan, fused stages in brackets,
+ * e.g. "[Grayscale + GaussianBlur] -> MOG2BackgroundSubtraction".
+ * @return The plan description.
+ */
+std::string FusedPipeline::getPlanDescription() const
+{
+    std::string description;
+
+    for(const auto& stage : stages)
+    {
+        if(!description.empty())
+        {
+            description += " -> ";
+        }
+
+        std::string stepNames;
+        for(const auto& step : stage.steps)
+        {
+            stepNames += stepNames.empty() ? "" : " + ";
+            stepNames += StepFactory::stepTypeToString(step->getType());
+        }
+
+        description += stage.isBanded ? "[" + stepNames + "]" : stepNames;
+    }
+
+    return description;
+}
+
+/**
+ * @brief Checks if a step only reads the rows near each output row,
+ * i.e. can be processed band by band. Threshold types computing a
+ * global threshold from the histogram (Otsu, Triangle) cannot.
+ * @param step The step to check.
+ * @return true if the step can be fused with its banded neighbours.
+ */
+bool FusedPipeline::isBandStep(const IPreprocessStep& step)
+{
+    switch(step.getType())
+    {
+    case StepType::Grayscale:
+    case StepType::GaussianBlur:
+    case StepType::Dilation:
+    case StepType::Erosion:
+        return true;
+
+    case StepType::Threshold: {
+        StepParameters params = step.getCurrentParameters();
+        auto thresholdParams = std::get_if<ThresholdParams>(&params.params);
+        return thresholdParams != nullptr &&
+               (thresholdParams->thresholdType &
+                (cv::THRESH_OTSU | cv::THRESH_TRIANGLE)) == 0;
+    }
+
+    default:
+        return false;
+    }
+}
+
+/**
+ * @brief Gets how many rows above and below a band all the steps of a
+ * builder read together, i.e. the rows of a crop that differ from the
+ * same rows processed on the whole frame. Global thresholds (Otsu,
+ * Triangle) and a downscaled MOG2 are not covered, they stay approximate.
+ * @param builder The builder holding the steps.
+ * @return The summed vertical kernel radius of the steps.
+ */
+int FusedPipeline::getPipelineHaloRows(const PipelineBuilder& builder)
+{
+    int haloRows = 0;
+    for(size_t i = 0; i < builder.getNumberOfSteps(); ++i)
+    {
+        haloRows += getHaloRows(builder.getStepCurrentParameters(i));
+    }
+
+    return haloRows;
+}
+
+/**
+ * @brief Gets how many rows above and below a band a step reads.
+ * @param params The parameters of a step for which isBandStep is true.
+ * @return The vertical kernel radius, times the iterations.
+ */
+int FusedPipeline::getHaloRows(const StepParameters& params)
+{
+    if(auto blur = std::get_if<GaussianBlurParams>(&params.params))
+        return blur->kernelSize / 2;
+
+    if(auto dilation = std::get_if<DilationParams>(&params.params))
+        return dilation->kernelSize.height / 2 * dilation->iterations;
+
+    if(auto erosion = std::get_if<ErosionParams>(&params.params))
+        return erosion->kernelSize.height / 2 * erosion->iterations;
+
+    return 0; // pointwise
+}
+
+/**
+ * @brief Gets the cv::Mat type a step outputs for a given input type.
+ * @param type The step type.
+ * @param inputType The cv::Mat type of the step input.
+ * @return The cv::Mat type of the step output.
+ */
+int FusedPipeline::getOutputType(StepType type, int inputType)
+{
+    switch(type)
+    {
+    case StepType::Grayscale:
+        return CV_MAKETYPE(CV_MAT_DEPTH(inputType), 1);
+    case StepType::MOG2BackgroundSubtraction:
+    case StepType::ApproxMedianBackgroundSubtraction:
+        return CV_8UC1;
+    default:
+        return inputType;
+    }
+}
+
+/**
+ * @brief Checks if a step computes each output pixel from the same pixel
+ * of the current and past frames only, i.e. can be split in row bands
+ * each with its own instance of the step. A downscaled MOG2 is kept
+ * whole, since a band shrunk on its own does not resize like its slice
+ * of the full frame.
+ * @param step The step.
+ * @return true if the step keeps an independent model per pixel.
+ */
+bool FusedPipeline::isPartitionStep(const IPreprocessStep& step)
+{
+    switch(step.getType())
+    {
+    case StepType::MOG2BackgroundSubtraction:
+    {
+        StepParameters params = step.getCurrentParameters();
+        auto p = std::get_if<MOG2BackgroundSubtractionParams>(&params.params);
+        return p && p->downscale <= 1;
+    }
+    case StepType::ApproxMedianBackgroundSubtraction:
+        return true;
+    default:
+        return false;
+    }
+}
+
+/**
+ * @brief Sizes the band heights and band buffers for the input format,
+ * only when the input size or type changed since the last frame.
+ * @param input The frame about to be processed.
+ */
+void FusedPipeline::prepare(const cv::Mat& input)
+{
+    if(input.size() == preparedSize && input.type() == preparedType)
+        return;
+
+    preparedSize = input.size();
+    preparedType = input.type();
+    stageFrames.resize(stages.size() - 1);
+
+    int type = input.type();
+    for(auto& stage : stages)
+    {
+        size_t rowBytes = input.cols * CV_ELEM_SIZE(type);
+
+        stage.outputTypes.clear();
+        for(const auto& step : stage.steps)
+        {
+            type = getOutputType(step->getType(), type);
+            stage.outputTypes.push_back(type);
+            rowBytes += input.cols * CV_ELEM_SIZE(type);
+        }
+
+        if(!stage.isBanded)
+        {
+            preparePartitions(stage, input.rows);
+            continue;
+        }
+
+        // the halo is processed twice, keep it small against the band
+        int budgetRows =
+            static_cast<int>(cacheBudget / rowBytes) - 2 * stage.haloRows;
+        stage.bandRows =
+            std::max({budgetRows, 4 * stage.haloRows, MIN_BAND_ROWS});
+
+        int bufferRows =
+            std::min(stage.bandRows + 2 * stage.haloRows, input.rows);
+
+        // each band of a parallel stage needs buffers of its own
+        int bandCount = (input.rows + stage.bandRows - 1) / stage.bandRows;
+        size_t bufferSets = parallelMode ? bandCount : 1;
+
+        stage.bandBuffers.resize(bufferSets);
+        stage.bandFrames.resize(bufferSets);
+        stage.bandStepNs.assign(bufferSets,
+                                std::vector<uint64_t>(stage.steps.size(), 0));
+        for(size_t set = 0; set < bufferSets; ++set)
+        {
+            stage.bandBuffers[set].resize(stage.steps.size());
+            stage.bandFrames[set].resize(stage.steps.size());
+            for(size_t i = 0; i < stage.steps.size(); ++i)
+            {
+                stage.bandBuffers[set][i].create(
+                    bufferRows, input.cols, stage.outputTypes[i]);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Creates the per band instances of a background model stage
+ * in parallel mode, one band per thread. Only runs on a format or mode
+ * change, and keeps the instances, i.e. the models, if the count holds.
+ * @param stage A stage that is not fused.
+ * @param rows The frame height.
+ */
+void FusedPipeline::preparePartitions(Stage& stage, int rows)
+{
+    const auto& step = stage.steps.front();
+    if(!parallelMode || !isPartitionStep(*step))
+    {
+        stage.partitionSteps.clear();
+        return;
+    }
+
+    size_t partitionCount = std::clamp(cv::getNumThreads(), 1, rows);
+    if(stage.partitionSteps.size() == partitionCount)
+        return;
+
+    // restarts the model, as would a size change of the full frame one
+    stage.partitionSteps.clear();
+    stage.partitionNs.assign(partitionCount, 0);
+    for(size_t i = 0; i < partitionCount; ++i)
+    {
+        stage.partitionSteps.emplace_back(StepFactory::createStep(
+            step->getType(), step->getCurrentParameters()));
+    }
+}
+
+/**
+ * @brief Runs one stage, band by band if fused, per row band model if
+ * split, otherwise like the builder: the first step writes into output,
+ * the rest run in place.
+ * @param stage The stage to run.
+ * @param input The stage input frame.
+ * @param output The stage output frame.
+ */
+void FusedPipeline::processStage(Stage& stage,
+                                 const cv::Mat& input,
+                                 cv::Mat& output)
+{
+    if(!stage.partitionSteps.empty())
+    {
+        processPartitions(stage, input, output);
+        return;
+    }
+
+    if(!stage.isBanded)
+    {
+        const auto& first = stage.steps.front();
+        StepTimings::measure(
+            timings, first->getType(), [&] { first->process(input, output); });
+
+        for(size_t i = 1; i < stage.steps.size(); ++i)
+        {
+            const auto& step = stage.steps[i];
+            StepTimings::measure(
+                timings, step->getType(), [&] { step->process(output); });
+        }
+        return;
+    }
+
+    output.create(input.size(), stage.outputTypes.back());
+
+    if(!parallelMode)
+    {
+        for(int firstRow = 0; firstRow < input.rows;
+            firstRow += stage.bandRows)
+        {
+            int lastRow = std::min(firstRow + stage.bandRows, input.rows);
+            processBand(stage, 0, input, output, firstRow, lastRow);
+        }
+        recordBandTimings(stage);
+        return;
+    }
+
+    // the bands only share the input, each has its own buffer set
+    int bandCount = static_cast<int>(stage.bandBuffers.size());
+    cv::parallel_for_(cv::Range(0, bandCount), [&](const cv::Range& bands) {
+        for(int band = bands.start; band < bands.end; ++band)
+        {
+            int firstRow = band * stage.bandRows;
+            int lastRow = std::min(firstRow + stage.bandRows, input.rows);
+            processBand(stage, band, input, output, firstRow, lastRow);
+        }
+    });
+    recordBandTimings(stage);
+}
+
+/**
+ * @brief Runs a background model stage split in row bands, each band
+ * with its own model instance and written straight into its output rows.
+ * @param stage A stage with partition steps, see preparePartitions.
+ * @param input The stage input frame.
+ * @param output The stage output frame.
+ */
+void FusedPipeline::processPartitions(Stage& stage,
+                                      const cv::Mat& input,
+                                      cv::Mat& output)
+{
+    output.create(input.size(), stage.outputTypes.back());
+
+    int partitionCount = static_cast<int>(stage.partitionSteps.size());
+    cv::parallel_for_(
+        cv::Range(0, partitionCount), [&](const cv::Range& partitions) {
+            for(int i = partitions.start; i < partitions.end; ++i)
+            {
+                int firstRow = input.rows * i / partitionCount;
+                int lastRow = input.rows * (i + 1) / partitionCount;
+
+                // same size and type, so the step writes in place
+                cv::Mat outputRows = output.rowRange(firstRow, lastRow);
+                StepTimings::Clock::time_point start;
+                if(timings != nullptr)
+                {
+                    start = StepTimings::Clock::now();
+                }
+
+                stage.partitionSteps[i]->process(
+                    input.rowRange(firstRow, lastRow), outputRows);
+
+                if(timings != nullptr)
+                {
+                    stage.partitionNs[i] = StepTimings::getElapsedNs(start);
+                }
+            }
+        });
+
+    if(timings != nullptr)
+    {
+        uint64_t totalNs = 0;
+        for(uint64_t partitionNs : stage.partitionNs)
+        {
+            totalNs += partitionNs;
+        }
+        timings->record(stage.steps.front()->getType(), totalNs);
+    }
+}
+
+/**
+ * @brief Records the step times of a fused stage summed over its bands,
+ * then clears them for the next frame. Nothing to do without timings.
+ * @param stage The fused stage, after all its bands ran.
+ */
+void FusedPipeline::recordBandTimings(Stage& stage)
+{
+    if(timings == nullptr)
+        return;
+
+    for(size_t i = 0; i < stage.steps.size(); ++i)
+    {
+        uint64_t totalNs = 0;
+        for(auto& stepNs : stage.bandStepNs)
+        {
+            totalNs += stepNs[i];
+            stepNs[i] = 0;
+        }
+        timings->record(stage.steps[i]->getType(), totalNs);
+    }
+}
+
+/**
+ * @brief Runs all the steps of a fused stage on one band plus its halo,
+ * then copies the rows of the band, which the halo kept exact, to output.
+ * @param stage The fused stage to run.
+ * @param bufferSet Index of the band buffer set to use.
+ * @param input The stage input frame.
+ * @param output The stage output frame, already allocated.
+ * @param firstRow First output row of the band.
+ * @param lastRow One past the last output row of the band.
+ */
+void FusedPipeline::processBand(Stage& stage,
+                                size_t bufferSet,
+                                const cv::Mat& input,
+                                cv::Mat& output,
+                                int firstRow,
+                                int lastRow)
+{
+    int top = std::max(firstRow - stage.haloRows, 0);
+    int bottom = std::min(lastRow + stage.haloRows, input.rows);
+
+    const cv::Mat bandInput = input.rowRange(top, bottom);
+    const cv::Mat* source = &bandInput;
+
+    for(size_t i = 0; i < stage.steps.size(); ++i)
+    {
+        // a header over the buffer start, not a ROI of it, so the steps
+        // see the band edges as borders instead of stale buffer rows
+        cv::Mat& bandFrame = stage.bandFrames[bufferSet][i];
+        bandFrame = cv::Mat(bottom - top,
+                            input.cols,
+                            stage.outputTypes[i],
+                            stage.bandBuffers[bufferSet][i].data);
+
+        if(timings == nullptr)
+        {
+            stage.steps[i]->process(*source, bandFrame);
+        }
+        else
+        {
+            StepTimings::Clock::time_point start = StepTimings::Clock::now();
+            stage.steps[i]->process(*source, bandFrame);
+            stage.bandStepNs[bufferSet][i] += StepTimings::getElapsedNs(start);
+        }
+        source = &bandFrame;
+    }
+
+    cv::Mat outputRows = output.rowRange(firstRow, lastRow);
+    source->rowRange(firstRow - top, lastRow - top).copyTo(outputRows);
+}
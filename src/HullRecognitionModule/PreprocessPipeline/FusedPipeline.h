@@ -0,0 +1,94 @@
+#ifndef FUSED_PIPELINE_H
+#define FUSED_PIPELINE_H
+
+#include "PipelineBuilder.h"
+
+/**
+ * @brief Execution plan compiled from the steps of a PipelineBuilder
+ * (e.g. the loaded pipeline_config). Runs of neighbouring steps that only
+ * read nearby rows (Grayscale, GaussianBlur, Threshold, Dilation, Erosion)
+ * are fused into one stage processed band by band, so each band stays in
+ * cache through the whole run instead of every step sweeping the frame.
+ * Bands overlap by the summed vertical kernel radius of the run (halo),
+ * so the output matches PipelineBuilder::process exactly.
+ * Stateful steps (MOG2) are a stage of their own, on the full frame.
+ * In parallel mode the bands of a fused stage run across the cores,
+ * and the per-pixel background models (MOG2, approximate median) are
+ * split in row bands with one model instance per band, which keeps the
+ * output identical to the serial plan. A downscaled MOG2 stays on the
+ * full frame, so its resize matches the serial plan too.
+ * With StepTimings set, a fused or split step records its time summed
+ * over the bands once per frame, i.e. its CPU time in parallel mode.
+ */
+class FusedPipeline
+{
+public:
+    FusedPipeline();
+
+    void compile(const PipelineBuilder& builder);
+    void process(const cv::Mat& input, cv::Mat& output);
+
+    void setCacheBudget(size_t bytes);
+    void setParallel(bool enable);
+    void setTimings(StepTimings* timings);
+    bool isParallel() const;
+    size_t getNumberOfStages() const;
+    std::string getPlanDescription() const;
+
+    static int getPipelineHaloRows(const PipelineBuilder& builder);
+
+private:
+    static constexpr size_t DEFAULT_CACHE_BUDGET = 256 * 1024;
+    static constexpr int MIN_BAND_ROWS = 16;
+
+    struct Stage
+    {
+        std::vector<std::unique_ptr<IPreprocessStep>> steps;
+        std::vector<int> outputTypes;
+        bool isBanded = false;
+        int haloRows = 0;
+        int bandRows = 0;
+
+        // band sized buffers of each step, and headers over them,
+        // one set per band in parallel mode, a single set otherwise
+        std::vector<std::vector<cv::Mat>> bandBuffers;
+        std::vector<std::vector<cv::Mat>> bandFrames;
+
+        // parallel mode, one instance of the pointwise step per row band
+        std::vector<std::unique_ptr<IPreprocessStep>> partitionSteps;
+
+        // with timings, the step times of each band/partition in a frame
+        std::vector<std::vector<uint64_t>> bandStepNs;
+        std::vector<uint64_t> partitionNs;
+    };
+
+    std::vector<Stage> stages;
+    std::vector<cv::Mat> stageFrames;
+    size_t cacheBudget;
+    bool parallelMode;
+    StepTimings* timings; // not owned, nullptr when disabled
+
+    cv::Size preparedSize;
+    int preparedType;
+
+    static bool isBandStep(const IPreprocessStep& step);
+    static int getHaloRows(const StepParameters& params);
+    static int getOutputType(StepType type, int inputType);
+    static bool isPartitionStep(const IPreprocessStep& step);
+
+    void prepare(const cv::Mat& input);
+    void preparePartitions(Stage& stage, int rows);
+    void processStage(Stage& stage, const cv::Mat& input, cv::Mat& output);
+    void processPartitions(Stage& stage,
+                           const cv::Mat& input,
+                           cv::Mat& output);
+    void recordBandTimings(Stage& stage);
+    void processBand(Stage& stage,
+                     size_t bufferSet,
+                     const cv::Mat& input,
+                     cv::Mat& output,
+                     int firstRow,
+                     int lastRow);
+};
+
+#endif
@@ -132,8 +132,46 @@ void PipelineBuilder::process(cv::Mat& frame)
 
     for(const auto& step : steps)
     {
-        step->process(frame);
+        StepTimings::measure(
+            timings, step->getType(), [&] { step->process(frame); });
+    }
+}
+
+/**
+ * @brief Preprocess image with the builder pattern, without copying the
+ * input first. The first step writes straight into the output buffer,
+ * the next steps then run in place on it, so with a pooled output that
+ * keeps its size and type between frames, nothing is allocated.
+ * @param input The image frame to be processed, left unchanged.
+ * @param output The processed frame.
+ */
+void PipelineBuilder::process(const cv::Mat& input, cv::Mat& output)
+{
+    if(steps.size() < 1)
+    {
+        input.copyTo(output);
+        return;
     }
+
+    StepTimings::measure(timings, steps.front()->getType(), [&] {
+        steps.front()->process(input, output);
+    });
+
+    for(size_t i = 1; i < steps.size(); ++i)
+    {
+        StepTimings::measure(
+            timings, steps[i]->getType(), [&] { steps[i]->process(output); });
+    }
+}
+
+/**
+ * @brief Records the duration of every step run by process, per StepType.
+ * @param timings The histograms to record into, owned by the caller,
+ * nullptr to stop recording.
+ */
+void PipelineBuilder::setTimings(StepTimings* timings)
+{
+    this->timings = timings;
 }
 
 /**
@@ -2,6 +2,7 @@
 #define PREPROCESS_PIPELINE_BUILDER_H
 
 #include "StepFactory.h"
+#include "StepTimings.h"
 
 /**
  * @brief Class for building the steps required
@@ -23,10 +24,14 @@ public:
     StepParameters getStepCurrentParameters(size_t stepIndex) const;
 
     void process(cv::Mat& frame);
+    void process(const cv::Mat& input, cv::Mat& output);
     void processDebugStack(cv::Mat& frame, int hStackLength = 3);
 
+    void setTimings(StepTimings* timings);
+
 private:
     std::vector<std::unique_ptr<IPreprocessStep>> steps;
+    StepTimings* timings = nullptr; // not owned, nullptr when disabled
 };
 
 #endif
\ No newline at end of file
@@ -1,4 +1,6 @@
 #include "PipelineDirector.h"
+#include <algorithm>
+#include <cmath>
 #include <fstream>
 
 /**
@@ -116,4 +118,123 @@ void PipelineDirector::loadPipelineConfig(PipelineBuilder& builder,
     }
 
     std::cout << "Pipeline config loaded from " << yamlFilename << ".\n";
-}
\ No newline at end of file
+}
+
+/**
+ * @brief non-member function, builds the first of KnownStaticPipelines,
+ * from Index on, that matches the builder.
+ * @param builder The builder holding the steps.
+ * @return The static pipeline, or nullptr if none matches.
+ */
+template<size_t Index = 0>
+static std::unique_ptr<IStaticPipeline>
+createFirstMatching(const PipelineBuilder& builder)
+{
+    if constexpr(Index == std::tuple_size_v<KnownStaticPipelines>)
+    {
+        return nullptr;
+    }
+    else
+    {
+        using Candidate = std::tuple_element_t<Index, KnownStaticPipelines>;
+        if(Candidate::matches(builder))
+            return std::make_unique<Candidate>(builder);
+
+        return createFirstMatching<Index + 1>(builder);
+    }
+}
+
+/**
+ * @brief Scales a morphology kernel so the total reach (radius times
+ * iterations) follows the frame scale. The iterations are scaled first,
+ * the kernel radius only once a single iteration is left.
+ * @param kernelSize The kernel size, odd on each axis.
+ * @param iterations The number of iterations.
+ * @param scale The frame size relative to the calibrated resolution.
+ */
+static void scaleMorphology(cv::Size& kernelSize, int& iterations,
+                            double scale)
+{
+    int radius = std::max(kernelSize.width, kernelSize.height) / 2;
+    if(radius <= 0 || iterations <= 0)
+        return;
+
+    double reach = radius * iterations * scale;
+    int scaledIterations = static_cast<int>(std::lround(reach / radius));
+    if(scaledIterations >= 1)
+    {
+        iterations = scaledIterations;
+        return;
+    }
+
+    double radiusScale = reach / radius;
+    auto scaleAxis = [radiusScale](int size)
+    {
+        int axisRadius = static_cast<int>(std::lround(size / 2 * radiusScale));
+        return 2 * std::max(axisRadius, 1) + 1;
+    };
+    kernelSize = cv::Size(scaleAxis(kernelSize.width),
+                          scaleAxis(kernelSize.height));
+    iterations = 1;
+}
+
+/**
+ * @brief Scales the spatial parameters of the steps (blur kernel and
+ * sigma, dilation and erosion reach) to frames processed at a different
+ * resolution than the one the config was tuned at, see the calibration
+ * key processing_scale. The scaled parameters may no longer match one of
+ * the known static pipelines, the builder then remains the pipeline.
+ * @param builder Reference to a PipelineBuilder instance holding the steps,
+ * e.g. after loadPipelineConfig.
+ * @param scale The frame size relative to the calibrated resolution.
+ */
+void PipelineDirector::scalePipeline(PipelineBuilder& builder, double scale)
+{
+    if(scale <= 0 || scale == 1.0)
+        return;
+
+    for(size_t i = 0; i < builder.getNumberOfSteps(); ++i)
+    {
+        StepParameters params = builder.getStepCurrentParameters(i);
+
+        if(auto p = std::get_if<GaussianBlurParams>(&params.params))
+        {
+            // a kernel size of 0 is derived from sigma by OpenCV
+            if(p->kernelSize > 1)
+            {
+                int radius = static_cast<int>(
+                    std::lround(p->kernelSize / 2 * scale));
+                p->kernelSize = 2 * radius + 1;
+            }
+            p->sigma *= scale;
+        }
+        else if(auto p = std::get_if<DilationParams>(&params.params))
+        {
+            scaleMorphology(p->kernelSize, p->iterations, scale);
+        }
+        else if(auto p = std::get_if<ErosionParams>(&params.params))
+        {
+            scaleMorphology(p->kernelSize, p->iterations, scale);
+        }
+        else
+        {
+            continue;
+        }
+
+        builder.setStepParameters(i, params);
+    }
+}
+
+/**
+ * @brief Selects the compile time specialized pipeline matching the steps
+ * of the builder, if any (see KnownStaticPipelines).
+ * @param builder Reference to a PipelineBuilder instance holding the steps,
+ * e.g. after loadPipelineConfig.
+ * @return The static pipeline built from the builder's parameters, or
+ * nullptr if none matches, the builder then remains the pipeline to use.
+ */
+std::unique_ptr<IStaticPipeline>
+PipelineDirector::createStaticPipeline(const PipelineBuilder& builder)
+{
+    return createFirstMatching(builder);
+}
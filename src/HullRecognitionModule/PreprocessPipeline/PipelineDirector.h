@@ -2,6 +2,8 @@
 #define PIPELINE_DIRECTOR_H
 
 #include "PipelineBuilder.h"
+#include "StaticPipeline.h"
+#include <memory>
 
 /**
  * @brief Director class to construct/save/load pipeline configurations.
@@ -15,6 +17,11 @@ public:
                             const cv::String& yamlFilename);
     void loadPipelineConfig(PipelineBuilder& builder,
                             const cv::String& yamlFilename);
+
+    static void scalePipeline(PipelineBuilder& builder, double scale);
+
+    static std::unique_ptr<IStaticPipeline>
+    createStaticPipeline(const PipelineBuilder& builder);
 };
 
 #endif
@@ -67,6 +67,7 @@ void PipelineTrackbar::initializeTrackbars()
             addTrackbar(i, "NMixtures", 5, 3, p.nMixtures);
             addTrackbar(i, "Detect Shadows", 1, 4, p.detectShadows);
             addTrackbar(i, "Shadow Value", 255, 5, p.shadowValue);
+            addTrackbar(i, "Downscale", 4, 6, p.downscale);
         }
             stepName += "MOG2 Background Subtraction";
             break;
@@ -85,6 +86,7 @@ void PipelineTrackbar::initializeTrackbars()
             addTrackbar(i, "Morph Shape", 2, 0, p.morphShape);
             addTrackbar(i, "Kernel Size", 21, 1, p.kernelSize.width);
             addTrackbar(i, "Iterations", 10, 2, p.iterations);
+            addTrackbar(i, "Optimized", 1, 3, p.optimized);
         }
             stepName += "Erosion";
             break;
@@ -94,9 +96,21 @@ void PipelineTrackbar::initializeTrackbars()
             addTrackbar(i, "Morph Shape", 2, 0, p.morphShape);
             addTrackbar(i, "Kernel Size", 21, 1, p.kernelSize.width);
             addTrackbar(i, "Iterations", 10, 2, p.iterations);
+            addTrackbar(i, "Optimized", 1, 3, p.optimized);
         }
             stepName += "Dilation";
             break;
+
+        case StepType::ApproxMedianBackgroundSubtraction: {
+            auto& p = std::get<ApproxMedianBackgroundSubtractionParams>(
+                initParam.params);
+            addTrackbar(i, "Threshold", 255, 0, p.threshold);
+            addTrackbar(i, "Step Size", 16, 1, p.stepSize);
+            addTrackbar(i, "Update Interval", 30, 2, p.updateInterval);
+            addTrackbar(i, "Foreground Value", 255, 3, p.foregroundValue);
+        }
+            stepName += "Approx Median Background Subtraction";
+            break;
         }
 
         cv::putText(displayPipelineInfo,
@@ -0,0 +1,238 @@
+#include "ApproxMedianBackgroundSubtractionStep.h"
+#include <algorithm>
+#include <opencv2/core/hal/intrin.hpp>
+#include <opencv2/core/version.hpp>
+
+/**
+ * @brief non-member function, the per-row kernel of the step. Labels the
+ * pixels differing from the background by more than the threshold, then
+ * moves the background up to stepSize toward the frame, never past it.
+ * Only uses saturating/min/max universal intrinsics, no comparisons,
+ * so it maps to SSE2, AVX2 and NEON alike.
+ * @param frame row of the uint8 single channel frame.
+ * @param background row of the background model, updated in place.
+ * @param mask row of the output mask, may alias the frame row.
+ * @param width number of pixels in the row.
+ * @param threshold minimum absolute difference of a foreground pixel.
+ * @param stepSize background update step, 0 to only compute the mask.
+ * @param foregroundValue mask value of the foreground pixels.
+ */
+static void subtractBackgroundRow(const uchar* frame,
+                                  uchar* background,
+                                  uchar* mask,
+                                  int width,
+                                  uchar threshold,
+                                  uchar stepSize,
+                                  uchar foregroundValue)
+{
+    int x = 0;
+
+#if CV_SIMD
+    const cv::v_uint8 thresholdVec = cv::vx_setall_u8(threshold);
+    const cv::v_uint8 stepVec = cv::vx_setall_u8(stepSize);
+    const cv::v_uint8 foregroundVec = cv::vx_setall_u8(foregroundValue);
+    const cv::v_uint8 oneVec = cv::vx_setall_u8(1);
+
+    // nlanes is deprecated since the scalable vectors of OpenCV 4.9
+#if CV_VERSION_MAJOR > 4 || (CV_VERSION_MAJOR == 4 && CV_VERSION_MINOR >= 9)
+    const int lanes = cv::VTraits<cv::v_uint8>::vlanes();
+#else
+    const int lanes = cv::v_uint8::nlanes;
+#endif
+
+    for(; x <= width - lanes; x += lanes)
+    {
+        cv::v_uint8 pixel = cv::vx_load(frame + x);
+        cv::v_uint8 model = cv::vx_load(background + x);
+
+        // difference above the threshold clamped to 0/1, then scaled
+        cv::v_uint8 excess = cv::v_sub_wrap(
+            cv::v_max(cv::v_absdiff(pixel, model), thresholdVec),
+            thresholdVec);
+        cv::v_store(mask + x,
+                    cv::v_mul_wrap(cv::v_min(excess, oneVec), foregroundVec));
+
+        cv::v_uint8 above = cv::v_sub_wrap(cv::v_max(pixel, model), model);
+        cv::v_uint8 below = cv::v_sub_wrap(model, cv::v_min(pixel, model));
+        model = cv::v_add_wrap(model, cv::v_min(above, stepVec));
+        model = cv::v_sub_wrap(model, cv::v_min(below, stepVec));
+        cv::v_store(background + x, model);
+    }
+#endif
+
+    for(; x < width; ++x)
+    {
+        int pixel = frame[x];
+        int model = background[x];
+
+        mask[x] = (std::abs(pixel - model) > threshold) ? foregroundValue : 0;
+
+        if(pixel > model)
+        {
+            background[x] = static_cast<uchar>(
+                model + std::min<int>(pixel - model, stepSize));
+        }
+        else
+        {
+            background[x] = static_cast<uchar>(
+                model - std::min<int>(model - pixel, stepSize));
+        }
+    }
+}
+
+ApproxMedianBackgroundSubtractionStep::ApproxMedianBackgroundSubtractionStep(
+    int threshold,
+    int stepSize,
+    int updateInterval,
+    int foregroundValue)
+    : threshold(threshold)
+    , stepSize(stepSize)
+    , updateInterval(updateInterval)
+    , foregroundValue(foregroundValue)
+    , frameCount(0)
+{
+    checkParameterValidity();
+}
+
+void ApproxMedianBackgroundSubtractionStep::process(cv::Mat& frame) const
+{
+    process(frame, frame);
+}
+
+void ApproxMedianBackgroundSubtractionStep::process(const cv::Mat& input,
+                                                    cv::Mat& output) const
+{
+    const cv::Mat* frame = &input;
+    if(input.channels() != 1)
+    {
+        cv::cvtColor(input, grayFrame, cv::COLOR_BGR2GRAY);
+        frame = &grayFrame;
+    }
+
+    // (re)start the model from the first frame, nothing is foreground yet
+    if(background.size() != frame->size())
+    {
+        frame->copyTo(background);
+        frameCount = 0;
+
+        output.create(frame->size(), CV_8UC1);
+        output.setTo(cv::Scalar::all(0));
+        return;
+    }
+
+    // the frame may be the output, it is read before the mask is written
+    output.create(frame->size(), CV_8UC1);
+
+    ++frameCount;
+    bool isUpdating = frameCount % updateInterval == 0;
+    uchar updateStep = isUpdating ? static_cast<uchar>(stepSize) : 0;
+
+    cv::parallel_for_(cv::Range(0, frame->rows), [&](const cv::Range& rows) {
+        for(int y = rows.start; y < rows.end; ++y)
+        {
+            subtractBackgroundRow(frame->ptr<uchar>(y),
+                                  background.ptr<uchar>(y),
+                                  output.ptr<uchar>(y),
+                                  frame->cols,
+                                  static_cast<uchar>(threshold),
+                                  updateStep,
+                                  static_cast<uchar>(foregroundValue));
+        }
+    });
+}
+
+void ApproxMedianBackgroundSubtractionStep::updateParameterById(
+    int paramId, const std::any& value)
+{
+    switch(paramId)
+    {
+    case 0: // threshold
+        if(value.type() == typeid(int))
+        {
+            threshold = std::any_cast<int>(value);
+        }
+        break;
+
+    case 1: // stepSize
+        if(value.type() == typeid(int))
+        {
+            stepSize = std::any_cast<int>(value);
+        }
+        break;
+
+    case 2: // updateInterval
+        if(value.type() == typeid(int))
+        {
+            updateInterval = std::any_cast<int>(value);
+        }
+        break;
+
+    case 3: // foregroundValue
+        if(value.type() == typeid(int))
+        {
+            foregroundValue = std::any_cast<int>(value);
+        }
+        break;
+
+    default:
+        std::cerr << "Error: Invalid parameter ID for "
+                     "ApproxMedianBackgroundSubtractionStep.\n";
+        break;
+    }
+
+    checkParameterValidity();
+}
+
+void ApproxMedianBackgroundSubtractionStep::setStepParameters(
+    const StepParameters& newParams)
+{
+    auto params = std::get_if<ApproxMedianBackgroundSubtractionParams>(
+        &newParams.params);
+    if(params == nullptr)
+    {
+        std::cerr << "Error: Please provide a valid "
+                     "ApproxMedianBackgroundSubtractionParams, or check if "
+                     "you are using the correct builder index.\n";
+        return;
+    }
+
+    threshold = params->threshold;
+    stepSize = params->stepSize;
+    updateInterval = params->updateInterval;
+    foregroundValue = params->foregroundValue;
+
+    checkParameterValidity();
+}
+
+StepType ApproxMedianBackgroundSubtractionStep::getType() const
+{
+    return StepType::ApproxMedianBackgroundSubtraction;
+}
+
+StepParameters
+ApproxMedianBackgroundSubtractionStep::getCurrentParameters() const
+{
+    ApproxMedianBackgroundSubtractionParams params;
+    params.threshold = threshold;
+    params.stepSize = stepSize;
+    params.updateInterval = updateInterval;
+    params.foregroundValue = foregroundValue;
+
+    StepParameters stepParams;
+    stepParams.params = params;
+
+    return stepParams;
+}
+
+void ApproxMedianBackgroundSubtractionStep::checkParameterValidity()
+{
+    // the kernel works on uint8 values
+    threshold = std::clamp(threshold, 0, 255);
+    stepSize = std::clamp(stepSize, 0, 255);
+    foregroundValue = std::clamp(foregroundValue, 0, 255);
+
+    if(updateInterval < 1)
+    {
+        updateInterval = 1;
+    }
+}
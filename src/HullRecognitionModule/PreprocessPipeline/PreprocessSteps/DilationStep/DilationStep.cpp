@@ -1,17 +1,33 @@
 #include "DilationStep.h"
 
-DilationStep::DilationStep(int morphShape, cv::Size kernelSize, int iterations)
+DilationStep::DilationStep(int morphShape,
+                           cv::Size kernelSize,
+                           int iterations,
+                           bool optimized)
     : morphShape(morphShape)
     , kernelSize(kernelSize)
     , iterations(iterations)
+    , optimized(optimized)
+    , fastDilation(cv::MORPH_DILATE)
 {
     checkDilationKernelValidity(kernelSize);
-    dilateKernel = cv::getStructuringElement(morphShape, kernelSize);
+    updateKernel();
 }
 
 void DilationStep::process(cv::Mat& frame) const
 {
-    cv::dilate(frame, frame, dilateKernel, cv::Point(-1, -1), iterations);
+    process(frame, frame);
+}
+
+void DilationStep::process(const cv::Mat& input, cv::Mat& output) const
+{
+    if(optimized)
+    {
+        fastDilation.apply(input, output);
+        return;
+    }
+
+    cv::dilate(input, output, dilateKernel, cv::Point(-1, -1), iterations);
 }
 
 void DilationStep::updateParameterById(int paramId, const std::any& value)
@@ -24,7 +40,7 @@ void DilationStep::updateParameterById(int paramId, const std::any& value)
             morphShape = std::any_cast<int>(value);
 
             checkDilationKernelValidity(kernelSize);
-            dilateKernel = cv::getStructuringElement(morphShape, kernelSize);
+            updateKernel();
         }
         break;
 
@@ -35,7 +51,7 @@ void DilationStep::updateParameterById(int paramId, const std::any& value)
             kernelSize = cv::Size(size, size);
 
             checkDilationKernelValidity(kernelSize);
-            dilateKernel = cv::getStructuringElement(morphShape, kernelSize);
+            updateKernel();
         }
         break;
 
@@ -43,6 +59,19 @@ void DilationStep::updateParameterById(int paramId, const std::any& value)
         if(value.type() == typeid(int))
         {
             iterations = std::any_cast<int>(value);
+            updateKernel();
+        }
+        break;
+
+    case 3: // optimized
+        if(value.type() == typeid(bool))
+        {
+            optimized = std::any_cast<bool>(value);
+        }
+        // Convert to bool; 0 is false, non-zero is true
+        else if(value.type() == typeid(int))
+        {
+            optimized = std::any_cast<int>(value) != 0;
         }
         break;
 
@@ -65,9 +94,10 @@ void DilationStep::setStepParameters(const StepParameters& newParams)
     morphShape = params->morphShape;
     kernelSize = params->kernelSize;
     iterations = params->iterations;
+    optimized = params->optimized;
 
     checkDilationKernelValidity(kernelSize);
-    dilateKernel = cv::getStructuringElement(morphShape, kernelSize);
+    updateKernel();
 }
 
 StepType DilationStep::getType() const
@@ -81,6 +111,7 @@ StepParameters DilationStep::getCurrentParameters() const
     params.morphShape = morphShape;
     params.kernelSize = kernelSize;
     params.iterations = iterations;
+    params.optimized = optimized;
 
     StepParameters stepParams;
     stepParams.params = params;
@@ -98,4 +129,10 @@ void DilationStep::checkDilationKernelValidity(cv::Size checkSize)
     {
         kernelSize.height = 1;
     }
-}
\ No newline at end of file
+}
+
+void DilationStep::updateKernel()
+{
+    dilateKernel = cv::getStructuringElement(morphShape, kernelSize);
+    fastDilation.setStructuringElement(morphShape, kernelSize, iterations);
+}
@@ -1,6 +1,7 @@
 #ifndef DILATION_STEP_H
 #define DILATION_STEP_H
 
+#include "FastMorphology.h"
 #include "IPreprocessStep.h"
 
 /**
@@ -11,9 +12,13 @@
 class DilationStep : public IPreprocessStep
 {
 public:
-    DilationStep(int morphShape, cv::Size kernelSize, int iterations);
+    DilationStep(int morphShape,
+                 cv::Size kernelSize,
+                 int iterations,
+                 bool optimized);
 
     void process(cv::Mat& frame) const override;
+    void process(const cv::Mat& input, cv::Mat& output) const override;
 
     void updateParameterById(int paramId, const std::any& value) override;
     void setStepParameters(const StepParameters& newParams) override;
@@ -27,7 +32,12 @@ private:
     cv::Size kernelSize;
     int iterations;
 
+    // iterations collapsed into one constant cost per pixel pass
+    bool optimized;
+    FastMorphology fastDilation;
+
     void checkDilationKernelValidity(cv::Size checkSize);
+    void updateKernel();
 };
 
 #endif
\ No newline at end of file
@@ -1,17 +1,33 @@
 #include "ErosionStep.h"
 
-ErosionStep::ErosionStep(int morphShape, cv::Size kernelSize, int iterations)
+ErosionStep::ErosionStep(int morphShape,
+                         cv::Size kernelSize,
+                         int iterations,
+                         bool optimized)
     : morphShape(morphShape)
     , kernelSize(kernelSize)
     , iterations(iterations)
+    , optimized(optimized)
+    , fastErosion(cv::MORPH_ERODE)
 {
     checkErosionKernelValidity(kernelSize);
-    erodeKernel = cv::getStructuringElement(morphShape, kernelSize);
+    updateKernel();
 }
 
 void ErosionStep::process(cv::Mat& frame) const
 {
-    cv::erode(frame, frame, erodeKernel, cv::Point(-1, -1), iterations);
+    process(frame, frame);
+}
+
+void ErosionStep::process(const cv::Mat& input, cv::Mat& output) const
+{
+    if(optimized)
+    {
+        fastErosion.apply(input, output);
+        return;
+    }
+
+    cv::erode(input, output, erodeKernel, cv::Point(-1, -1), iterations);
 }
 
 void ErosionStep::updateParameterById(int paramId, const std::any& value)
@@ -24,7 +40,7 @@ void ErosionStep::updateParameterById(int paramId, const std::any& value)
             morphShape = std::any_cast<int>(value);
 
             checkErosionKernelValidity(kernelSize);
-            erodeKernel = cv::getStructuringElement(morphShape, kernelSize);
+            updateKernel();
         }
         break;
 
@@ -35,7 +51,7 @@ void ErosionStep::updateParameterById(int paramId, const std::any& value)
             kernelSize = cv::Size(size, size);
 
             checkErosionKernelValidity(kernelSize);
-            erodeKernel = cv::getStructuringElement(morphShape, kernelSize);
+            updateKernel();
         }
         break;
 
@@ -43,6 +59,19 @@ void ErosionStep::updateParameterById(int paramId, const std::any& value)
         if(value.type() == typeid(int))
         {
             iterations = std::any_cast<int>(value);
+            updateKernel();
+        }
+        break;
+
+    case 3: // optimized
+        if(value.type() == typeid(bool))
+        {
+            optimized = std::any_cast<bool>(value);
+        }
+        // Convert to bool; 0 is false, non-zero is true
+        else if(value.type() == typeid(int))
+        {
+            optimized = std::any_cast<int>(value) != 0;
         }
         break;
 
@@ -65,9 +94,10 @@ void ErosionStep::setStepParameters(const StepParameters& newParams)
     morphShape = params->morphShape;
     kernelSize = params->kernelSize;
     iterations = params->iterations;
+    optimized = params->optimized;
 
     checkErosionKernelValidity(kernelSize);
-    erodeKernel = cv::getStructuringElement(morphShape, kernelSize);
+    updateKernel();
 }
 
 StepType ErosionStep::getType() const
@@ -81,6 +111,7 @@ StepParameters ErosionStep::getCurrentParameters() const
     params.morphShape = morphShape;
     params.kernelSize = kernelSize;
     params.iterations = iterations;
+    params.optimized = optimized;
 
     StepParameters stepParams;
     stepParams.params = params;
@@ -98,4 +129,10 @@ void ErosionStep::checkErosionKernelValidity(cv::Size checkSize)
     {
         kernelSize.height = 1;
     }
-}
\ No newline at end of file
+}
+
+void ErosionStep::updateKernel()
+{
+    erodeKernel = cv::getStructuringElement(morphShape, kernelSize);
+    fastErosion.setStructuringElement(morphShape, kernelSize, iterations);
+}
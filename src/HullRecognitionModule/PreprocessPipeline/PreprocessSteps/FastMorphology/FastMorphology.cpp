@@ -0,0 +1,442 @@
+#include "FastMorphology.h"
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+constexpr int COLUMN_STRIP = 64; // bytes, one cache line per row
+
+struct MaxOp
+{
+    static constexpr uchar IDENTITY = 0;
+    static uchar apply(uchar a, uchar b) { return std::max(a, b); }
+};
+
+struct MinOp
+{
+    static constexpr uchar IDENTITY = 255;
+    static uchar apply(uchar a, uchar b) { return std::min(a, b); }
+};
+} // namespace
+
+/**
+ * @brief non-member function, running max/min of one row over a centered
+ * window (van Herk/Gil-Werman). The padded row is cut in blocks of the
+ * window length, each window spans the end of a block and the start of
+ * the next, so it is the max/min of one suffix and one prefix value.
+ * Pixels outside the row are ignored, like the default morphology border.
+ * @param source row of the input.
+ * @param destination row of the output, must not alias the input row.
+ * @param width number of pixels in the row.
+ * @param radius half window length.
+ * @param padded scratch, the row with radius identity pixels on each side.
+ * @param prefix scratch, max/min from the block start.
+ * @param suffix scratch, max/min up to the block end.
+ */
+template<typename Op>
+static void filterRow(const uchar* source,
+                      uchar* destination,
+                      int width,
+                      int radius,
+                      std::vector<uchar>& padded,
+                      std::vector<uchar>& prefix,
+                      std::vector<uchar>& suffix)
+{
+    int window = 2 * radius + 1;
+    int paddedWidth = (width + 2 * radius + window - 1) / window * window;
+
+    padded.assign(paddedWidth, Op::IDENTITY);
+    prefix.resize(paddedWidth);
+    suffix.resize(paddedWidth);
+    std::memcpy(padded.data() + radius, source, width);
+
+    for(int start = 0; start < paddedWidth; start += window)
+    {
+        int end = start + window - 1;
+
+        prefix[start] = padded[start];
+        for(int i = start + 1; i <= end; ++i)
+        {
+            prefix[i] = Op::apply(prefix[i - 1], padded[i]);
+        }
+
+        suffix[end] = padded[end];
+        for(int i = end - 1; i >= start; --i)
+        {
+            suffix[i] = Op::apply(suffix[i + 1], padded[i]);
+        }
+    }
+
+    for(int x = 0; x < width; ++x)
+    {
+        destination[x] = Op::apply(suffix[x], prefix[x + 2 * radius]);
+    }
+}
+
+/**
+ * @brief non-member function, same running max/min as filterRow along
+ * the columns, processed a row at a time over a strip of columns so the
+ * inner loops run over contiguous pixels.
+ * @param source the input frame.
+ * @param destination the output frame, must not alias the input.
+ * @param radius half window height.
+ * @param accumulate true to combine with the destination pixels
+ * instead of overwriting them.
+ * @param prefix scratch, padded rows x columns.
+ * @param suffix scratch, padded rows x columns.
+ * @param identityRow a row of identity pixels, for the padding rows.
+ * @param columns the strip of columns to process.
+ */
+template<typename Op>
+static void filterColumns(const cv::Mat& source,
+                          cv::Mat& destination,
+                          int radius,
+                          bool accumulate,
+                          cv::Mat& prefix,
+                          cv::Mat& suffix,
+                          const uchar* identityRow,
+                          const cv::Range& columns)
+{
+    int window = 2 * radius + 1;
+    int first = columns.start;
+    int count = columns.end - columns.start;
+
+    auto paddedRow = [&](int i) {
+        int y = i - radius;
+        return (y >= 0 && y < source.rows) ? source.ptr<uchar>(y) + first
+                                           : identityRow;
+    };
+
+    for(int start = 0; start < prefix.rows; start += window)
+    {
+        int end = start + window - 1;
+
+        std::memcpy(prefix.ptr<uchar>(start) + first, paddedRow(start), count);
+        for(int i = start + 1; i <= end; ++i)
+        {
+            const uchar* row = paddedRow(i);
+            const uchar* previous = prefix.ptr<uchar>(i - 1) + first;
+            uchar* current = prefix.ptr<uchar>(i) + first;
+            for(int x = 0; x < count; ++x)
+            {
+                current[x] = Op::apply(previous[x], row[x]);
+            }
+        }
+
+        std::memcpy(suffix.ptr<uchar>(end) + first, paddedRow(end), count);
+        for(int i = end - 1; i >= start; --i)
+        {
+            const uchar* row = paddedRow(i);
+            const uchar* next = suffix.ptr<uchar>(i + 1) + first;
+            uchar* current = suffix.ptr<uchar>(i) + first;
+            for(int x = 0; x < count; ++x)
+            {
+                current[x] = Op::apply(next[x], row[x]);
+            }
+        }
+    }
+
+    for(int y = 0; y < destination.rows; ++y)
+    {
+        const uchar* top = suffix.ptr<uchar>(y) + first;
+        const uchar* bottom = prefix.ptr<uchar>(y + 2 * radius) + first;
+        uchar* output = destination.ptr<uchar>(y) + first;
+        for(int x = 0; x < count; ++x)
+        {
+            uchar value = Op::apply(top[x], bottom[x]);
+            output[x] = accumulate ? Op::apply(output[x], value) : value;
+        }
+    }
+}
+
+/**
+ * @brief non-member function, applies the union of the centered
+ * rectangles: each rectangle is a row pass then a column pass, whose
+ * result is combined into the output.
+ * @param source the input frame, must not alias the output.
+ * @param output the output frame, already allocated.
+ * @param rectRadii half sizes of the rectangles.
+ * @param scratch buffers of the calling thread, sized here before the
+ * parallel passes, which share them (each writes its own rows/columns).
+ */
+template<typename Op>
+static void applyRects(const cv::Mat& source,
+                       cv::Mat& output,
+                       const std::vector<cv::Size>& rectRadii,
+                       FastMorphology::Scratch& scratch)
+{
+    cv::Mat& rowPass = scratch.rowPass;
+    cv::Mat& prefix = scratch.prefix;
+    cv::Mat& suffix = scratch.suffix;
+
+    rowPass.create(source.size(), CV_8UC1);
+    scratch.identityRow.assign(source.cols, Op::IDENTITY);
+    const uchar* identityRow = scratch.identityRow.data();
+
+    for(size_t i = 0; i < rectRadii.size(); ++i)
+    {
+        int radiusX = rectRadii[i].width;
+        int radiusY = rectRadii[i].height;
+
+        cv::parallel_for_(
+            cv::Range(0, source.rows), [&](const cv::Range& rows) {
+                // per worker thread, only used within this range
+                thread_local std::vector<uchar> padded;
+                thread_local std::vector<uchar> rowPrefix;
+                thread_local std::vector<uchar> rowSuffix;
+                for(int y = rows.start; y < rows.end; ++y)
+                {
+                    filterRow<Op>(source.ptr<uchar>(y),
+                                  rowPass.ptr<uchar>(y),
+                                  source.cols,
+                                  radiusX,
+                                  padded,
+                                  rowPrefix,
+                                  rowSuffix);
+                }
+            });
+
+        int window = 2 * radiusY + 1;
+        int paddedRows =
+            (source.rows + 2 * radiusY + window - 1) / window * window;
+        prefix.create(paddedRows, source.cols, CV_8UC1);
+        suffix.create(paddedRows, source.cols, CV_8UC1);
+
+        double stripCount = (source.cols + COLUMN_STRIP - 1) / COLUMN_STRIP;
+        cv::parallel_for_(
+            cv::Range(0, source.cols),
+            [&](const cv::Range& columns) {
+                filterColumns<Op>(rowPass,
+                                  output,
+                                  radiusY,
+                                  i > 0,
+                                  prefix,
+                                  suffix,
+                                  identityRow,
+                                  columns);
+            },
+            stripCount);
+    }
+}
+
+FastMorphology::FastMorphology(int operation)
+    : operation(operation)
+    , iterations(1)
+    , isSupported(false)
+    , exact(false)
+{}
+
+/**
+ * @brief Precomputes the rectangles of the element equivalent to
+ * iterating the given one, i.e. the element dilated by itself.
+ * @param morphShape Shape of the structuring element (cv::MorphShapes).
+ * @param kernelSize Size of the structuring element, odd to be optimized.
+ * @param iterations Number of times the operation is applied.
+ */
+void FastMorphology::setStructuringElement(int morphShape,
+                                           cv::Size kernelSize,
+                                           int iterations)
+{
+    kernel = cv::getStructuringElement(morphShape, kernelSize);
+    this->iterations = iterations;
+    rectRadii.clear();
+
+    // even kernels have an off-center anchor, left to cv::morphologyEx
+    isSupported = kernelSize.width % 2 == 1 && kernelSize.height % 2 == 1;
+    exact = isSupported;
+    if(!isSupported)
+        return;
+
+    int radiusX = kernelSize.width / 2 * std::max(iterations, 0);
+    int radiusY = kernelSize.height / 2 * std::max(iterations, 0);
+    if(morphShape == cv::MORPH_RECT || iterations < 1)
+    {
+        rectRadii.emplace_back(radiusX, radiusY);
+        return;
+    }
+
+    // a single point dilated by the iterated element draws its equivalent
+    cv::Mat element = cv::Mat::zeros(2 * radiusY + 1, 2 * radiusX + 1, CV_8UC1);
+    element.at<uchar>(radiusY, radiusX) = 255;
+    cv::dilate(element, element, kernel, cv::Point(-1, -1), iterations);
+
+    std::vector<cv::Size> staircase = getStaircase(element);
+    rectRadii = selectLargestUnion(staircase, MAX_RECTS);
+
+    cv::Mat rectUnion = cv::Mat::zeros(element.size(), CV_8UC1);
+    for(const auto& radii : rectRadii)
+    {
+        cv::Rect rect(radiusX - radii.width,
+                      radiusY - radii.height,
+                      2 * radii.width + 1,
+                      2 * radii.height + 1);
+        rectUnion(rect).setTo(cv::Scalar::all(255));
+    }
+    exact = cv::countNonZero(rectUnion != element) == 0;
+}
+
+/**
+ * @brief Dilates or erodes the frame with the equivalent element,
+ * ignoring the pixels outside of the frame like cv::dilate/cv::erode.
+ * @param input The frame to process, may be the output.
+ * @param output The processed frame.
+ */
+void FastMorphology::apply(const cv::Mat& input, cv::Mat& output) const
+{
+    if(!isSupported || input.type() != CV_8UC1)
+    {
+        cv::morphologyEx(
+            input, output, operation, kernel, cv::Point(-1, -1), iterations);
+        return;
+    }
+
+    // per calling thread, so concurrent bands of a frame do not share
+    // them, handed to the parallel passes by reference
+    thread_local Scratch scratch;
+
+    // every rectangle reads the input, keep it when processing in place
+    const cv::Mat* source = &input;
+    if(input.data == output.data)
+    {
+        input.copyTo(scratch.inputCopy);
+        source = &scratch.inputCopy;
+    }
+
+    output.create(input.size(), CV_8UC1);
+
+    if(operation == cv::MORPH_DILATE)
+    {
+        applyRects<MaxOp>(*source, output, rectRadii, scratch);
+    }
+    else
+    {
+        applyRects<MinOp>(*source, output, rectRadii, scratch);
+    }
+}
+
+/**
+ * @brief Checks if the rectangles match the iterated element exactly,
+ * otherwise they cover the largest part of it that MAX_RECTS can.
+ * @return true if the rectangles are the equivalent element, apply then
+ * gives the same result as cv::morphologyEx away from the frame borders.
+ */
+bool FastMorphology::isExact() const
+{
+    return exact;
+}
+
+/**
+ * @brief Splits a symmetric element, whose rows are centered intervals
+ * narrowing away from the center row, in centered rectangles: one per
+ * row width, as tall as the rows at least that wide.
+ * @param element The element, of odd width and height.
+ * @return Half sizes of the rectangles, widest (and shortest) first.
+ */
+std::vector<cv::Size> FastMorphology::getStaircase(const cv::Mat& element)
+{
+    int centerX = element.cols / 2;
+    int centerY = element.rows / 2;
+
+    // half height of the rows at least as wide as each half width
+    std::vector<int> halfHeights(centerX + 1, -1);
+    for(int y = 0; y < element.rows; ++y)
+    {
+        const uchar* row = element.ptr<uchar>(y);
+        int halfWidth = -1;
+        for(int x = 0; x <= centerX; ++x)
+        {
+            if(row[x] != 0)
+            {
+                halfWidth = centerX - x;
+                break;
+            }
+        }
+
+        for(int width = 0; width <= halfWidth; ++width)
+        {
+            halfHeights[width] =
+                std::max(halfHeights[width], std::abs(y - centerY));
+        }
+    }
+
+    // a step narrower than the previous one only helps if it is taller
+    std::vector<cv::Size> staircase;
+    for(int width = centerX; width >= 0; --width)
+    {
+        if(halfHeights[width] < 0)
+            continue;
+
+        if(staircase.empty() || halfHeights[width] > staircase.back().height)
+        {
+            staircase.emplace_back(width, halfHeights[width]);
+        }
+    }
+
+    return staircase;
+}
+
+/**
+ * @brief Picks the steps of a staircase whose union covers the most
+ * pixels, using at most maxRects of them (dynamic programming over the
+ * steps, in order of increasing height).
+ * @param staircase Half sizes of the steps, widest first.
+ * @param maxRects Maximum number of steps to keep.
+ * @return Half sizes of the kept steps.
+ */
+std::vector<cv::Size>
+FastMorphology::selectLargestUnion(const std::vector<cv::Size>& staircase,
+                                   size_t maxRects)
+{
+    size_t stepCount = staircase.size();
+    if(stepCount <= maxRects)
+        return staircase;
+
+    auto width = [&](size_t i) { return 2 * staircase[i].width + 1; };
+    auto height = [&](size_t i) { return 2 * staircase[i].height + 1; };
+
+    // area[k][i]: largest union of k + 1 steps, the tallest being step i
+    std::vector<std::vector<long long>> area(
+        maxRects, std::vector<long long>(stepCount, 0));
+    std::vector<std::vector<size_t>> previous(
+        maxRects, std::vector<size_t>(stepCount, 0));
+
+    for(size_t i = 0; i < stepCount; ++i)
+    {
+        area[0][i] = static_cast<long long>(width(i)) * height(i);
+    }
+
+    for(size_t k = 1; k < maxRects; ++k)
+    {
+        for(size_t i = k; i < stepCount; ++i)
+        {
+            for(size_t p = k - 1; p < i; ++p)
+            {
+                long long candidate =
+                    area[k - 1][p] +
+                    static_cast<long long>(width(i)) * (height(i) - height(p));
+                if(candidate > area[k][i])
+                {
+                    area[k][i] = candidate;
+                    previous[k][i] = p;
+                }
+            }
+        }
+    }
+
+    // more steps never cover less, the best union uses all of them
+    const auto& best = area[maxRects - 1];
+    size_t step = std::max_element(best.begin(), best.end()) - best.begin();
+
+    std::vector<cv::Size> selected;
+    for(size_t k = maxRects - 1;; --k)
+    {
+        selected.push_back(staircase[step]);
+        if(k == 0)
+            break;
+
+        step = previous[k][step];
+    }
+
+    std::reverse(selected.begin(), selected.end());
+    return selected;
+}
@@ -0,0 +1,64 @@
+#ifndef FAST_MORPHOLOGY_H
+#define FAST_MORPHOLOGY_H
+
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+/**
+ * @brief Dilation/erosion of uint8 single channel frames at a constant
+ * cost per pixel, whatever the kernel size and the iteration count.
+ * The iterations are collapsed into their one pass equivalent element,
+ * which is split into at most MAX_RECTS centered rectangles. Each of them
+ * is applied as two separable running max/min passes (van Herk/Gil-Werman)
+ * costing about 3 comparisons per pixel, the results are combined.
+ * The element is the equivalent one for rectangles; for ellipses and
+ * crosses, if it has few enough widths, otherwise the largest staircase of
+ * rectangles inscribed in it. Within (iterations - 1) kernel radii of the
+ * frame borders the result can still differ from iterating, since each
+ * iteration ignores the pixels outside of the frame while the collapsed
+ * element reaches past them. Other formats and even kernel sizes fall
+ * back to cv::morphologyEx.
+ */
+class FastMorphology
+{
+public:
+    explicit FastMorphology(int operation);
+
+    void setStructuringElement(int morphShape,
+                               cv::Size kernelSize,
+                               int iterations);
+    void apply(const cv::Mat& input, cv::Mat& output) const;
+
+    bool isExact() const;
+
+    // buffers of apply, reused across the frames of a calling thread
+    struct Scratch
+    {
+        cv::Mat inputCopy;
+        cv::Mat rowPass;
+        cv::Mat prefix;
+        cv::Mat suffix;
+        std::vector<uchar> identityRow;
+    };
+
+private:
+    static constexpr size_t MAX_RECTS = 4;
+
+    int operation; // cv::MORPH_DILATE or cv::MORPH_ERODE
+
+    // fallback
+    cv::Mat kernel;
+    int iterations;
+    bool isSupported;
+
+    // half sizes of the rectangles whose union is the equivalent element
+    std::vector<cv::Size> rectRadii;
+    bool exact;
+
+    static std::vector<cv::Size> getStaircase(const cv::Mat& element);
+    static std::vector<cv::Size>
+    selectLargestUnion(const std::vector<cv::Size>& staircase,
+                       size_t maxRects);
+};
+
+#endif
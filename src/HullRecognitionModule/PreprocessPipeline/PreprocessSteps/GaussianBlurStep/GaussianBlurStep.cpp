@@ -12,6 +12,11 @@ void GaussianBlurStep::process(cv::Mat& frame) const
     cv::GaussianBlur(frame, frame, cv::Size(kernelSize, kernelSize), sigma);
 }
 
+void GaussianBlurStep::process(const cv::Mat& input, cv::Mat& output) const
+{
+    cv::GaussianBlur(input, output, cv::Size(kernelSize, kernelSize), sigma);
+}
+
 void GaussianBlurStep::updateParameterById(int paramId, const std::any& value)
 {
     switch(paramId)
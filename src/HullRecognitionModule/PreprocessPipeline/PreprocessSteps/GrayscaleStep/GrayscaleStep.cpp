@@ -7,6 +7,16 @@ void GrayscaleStep::process(cv::Mat& frame) const
     cv::cvtColor(frame, frame, cv::COLOR_BGR2GRAY);
 }
 
+void GrayscaleStep::process(const cv::Mat& input, cv::Mat& output) const
+{
+    if(input.channels() == 1)
+    {
+        input.copyTo(output);
+        return;
+    }
+    cv::cvtColor(input, output, cv::COLOR_BGR2GRAY);
+}
+
 void GrayscaleStep::updateParameterById(int paramId, const std::any& value)
 {
     std::cout << "No parameter to set for grayscale\n";
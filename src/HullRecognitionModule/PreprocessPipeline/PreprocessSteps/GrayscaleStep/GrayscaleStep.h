@@ -12,6 +12,7 @@ class GrayscaleStep : public IPreprocessStep
 {
 public:
     void process(cv::Mat& frame) const override;
+    void process(const cv::Mat& input, cv::Mat& output) const override;
 
     void updateParameterById(int paramId, const std::any& value) override;
     void setStepParameters(const StepParameters& params) override;
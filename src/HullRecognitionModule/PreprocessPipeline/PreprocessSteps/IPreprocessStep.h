@@ -23,6 +23,20 @@ public:
      */
     virtual void process(cv::Mat& frame) const = 0;
 
+    /**
+     * @brief Applies the preprocessing operation from input into output,
+     * so the first step can write straight into a pooled buffer.
+     * Steps should override this with the non in-place form of their
+     * operation, the default copies then processes in place.
+     * @param input The image frame to be processed, left unchanged.
+     * @param output The processed frame, its buffer is reused if possible.
+     */
+    virtual void process(const cv::Mat& input, cv::Mat& output) const
+    {
+        input.copyTo(output);
+        process(output);
+    }
+
     /**
      * @brief Dynamically updates a specific parameter of the preprocessing step.
      * @param paramId An identifier for the parameter to update.
@@ -1,4 +1,5 @@
 #include "MOG2BackgroundSubtractionStep.h"
+#include <algorithm>
 
 MOG2BackgroundSubtractionStep::MOG2BackgroundSubtractionStep(
     int history,
@@ -6,14 +7,18 @@ MOG2BackgroundSubtractionStep::MOG2BackgroundSubtractionStep(
     double varThresholdGen,
     int nMixtures,
     bool detectShadows,
-    int shadowValue)
+    int shadowValue,
+    int downscale)
     : history(history)
     , varThreshold(varThreshold)
     , varThresholdGen(varThresholdGen)
     , nMixtures(nMixtures)
     , detectShadows(detectShadows)
     , shadowValue(shadowValue)
+    , downscale(downscale)
 {
+    checkParameterValidity();
+
     bgSubtractor = cv::createBackgroundSubtractorMOG2();
     bgSubtractor->setHistory(history);
     bgSubtractor->setVarThreshold(varThreshold);
@@ -25,7 +30,26 @@ MOG2BackgroundSubtractionStep::MOG2BackgroundSubtractionStep(
 
 void MOG2BackgroundSubtractionStep::process(cv::Mat& frame) const
 {
-    bgSubtractor->apply(frame, frame);
+    process(frame, frame);
+}
+
+void MOG2BackgroundSubtractionStep::process(const cv::Mat& input,
+                                            cv::Mat& output) const
+{
+    if(downscale == 1)
+    {
+        bgSubtractor->apply(input, output);
+        return;
+    }
+
+    // rounded up, so a partial block at the edge still gets a pixel
+    cv::Size smallSize((input.cols + downscale - 1) / downscale,
+                       (input.rows + downscale - 1) / downscale);
+    cv::resize(input, smallFrame, smallSize, 0, 0, cv::INTER_AREA);
+    bgSubtractor->apply(smallFrame, smallMask);
+
+    // the input may be the output, it was already read
+    cv::resize(smallMask, output, input.size(), 0, 0, cv::INTER_NEAREST);
 }
 
 void MOG2BackgroundSubtractionStep::updateParameterById(int paramId,
@@ -97,11 +121,20 @@ void MOG2BackgroundSubtractionStep::updateParameterById(int paramId,
         bgSubtractor->setShadowValue(shadowValue);
         break;
 
+    case 6: // downscale
+        if(value.type() == typeid(int))
+        {
+            downscale = std::any_cast<int>(value);
+        }
+        break;
+
     default:
         std::cerr << "Error: Invalid parameter ID for "
                      "MOG2BackgroundSubtractionStep.\n";
         break;
     }
+
+    checkParameterValidity();
 }
 
 void MOG2BackgroundSubtractionStep::setStepParameters(
@@ -117,12 +150,22 @@ void MOG2BackgroundSubtractionStep::setStepParameters(
         return;
     }
 
-    bgSubtractor->setHistory(params->history);
-    bgSubtractor->setVarThreshold(params->varThreshold);
-    bgSubtractor->setVarThresholdGen(params->varThresholdGen);
-    bgSubtractor->setNMixtures(params->nMixtures);
-    bgSubtractor->setDetectShadows(params->detectShadows);
-    bgSubtractor->setShadowValue(params->shadowValue);
+    history = params->history;
+    varThreshold = params->varThreshold;
+    varThresholdGen = params->varThresholdGen;
+    nMixtures = params->nMixtures;
+    detectShadows = params->detectShadows;
+    shadowValue = params->shadowValue;
+    downscale = params->downscale;
+
+    bgSubtractor->setHistory(history);
+    bgSubtractor->setVarThreshold(varThreshold);
+    bgSubtractor->setVarThresholdGen(varThresholdGen);
+    bgSubtractor->setNMixtures(nMixtures);
+    bgSubtractor->setDetectShadows(detectShadows);
+    bgSubtractor->setShadowValue(shadowValue);
+
+    checkParameterValidity();
 }
 
 StepType MOG2BackgroundSubtractionStep::getType() const
@@ -139,9 +182,16 @@ StepParameters MOG2BackgroundSubtractionStep::getCurrentParameters() const
     params.nMixtures = nMixtures;
     params.detectShadows = detectShadows;
     params.shadowValue = shadowValue;
+    params.downscale = downscale;
 
     StepParameters stepParams;
     stepParams.params = params;
 
     return stepParams;
 }
+
+void MOG2BackgroundSubtractionStep::checkParameterValidity()
+{
+    // a model size change restarts it, see cv::BackgroundSubtractorMOG2
+    downscale = std::clamp(downscale, 1, MAX_DOWNSCALE);
+}
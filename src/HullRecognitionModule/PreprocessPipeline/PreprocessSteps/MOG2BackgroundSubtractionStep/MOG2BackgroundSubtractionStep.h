@@ -7,6 +7,8 @@
  * @brief Represents a MOG2 Background Subtraction preprocessing step.
  * Implements a MOG2 Background Subtraction operation as part of the
  * image preprocessing pipeline. It extends the IPreprocessStep interface.
+ * With a downscale factor, the model runs on the shrunk frame and the
+ * mask is scaled back up (nearest neighbour, labels are kept as is).
  */
 class MOG2BackgroundSubtractionStep : public IPreprocessStep
 {
@@ -16,9 +18,11 @@ public:
                                   double varThresholdGen,
                                   int nMixtures,
                                   bool detectShadows,
-                                  int shadowValue);
+                                  int shadowValue,
+                                  int downscale = 1);
 
     void process(cv::Mat& frame) const override;
+    void process(const cv::Mat& input, cv::Mat& output) const override;
 
     void updateParameterById(int paramId, const std::any& value) override;
     void setStepParameters(const StepParameters& newParams) override;
@@ -27,6 +31,8 @@ public:
     StepParameters getCurrentParameters() const override;
 
 private:
+    static constexpr int MAX_DOWNSCALE = 4;
+
     cv::Ptr<cv::BackgroundSubtractorMOG2> bgSubtractor;
     int history;
     double varThreshold;
@@ -34,6 +40,13 @@ private:
     int nMixtures;
     bool detectShadows;
     int shadowValue;
+    int downscale;
+
+    // the shrunk frame and mask, reused across frames
+    mutable cv::Mat smallFrame;
+    mutable cv::Mat smallMask;
+
+    void checkParameterValidity();
 };
 
 #endif
\ No newline at end of file
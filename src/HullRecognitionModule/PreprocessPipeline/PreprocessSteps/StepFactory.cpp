@@ -1,4 +1,5 @@
 #include "StepFactory.h"
+#include "ApproxMedianBackgroundSubtractionStep.h"
 #include "DilationStep.h"
 #include "ErosionStep.h"
 #include "GaussianBlurStep.h"
@@ -38,7 +39,8 @@ StepFactory::createStep(StepType stepType, const StepParameters& params)
                 p->varThresholdGen,
                 p->nMixtures,
                 p->detectShadows,
-                p->shadowValue);
+                p->shadowValue,
+                p->downscale);
         }
         break;
     }
@@ -56,7 +58,7 @@ StepFactory::createStep(StepType stepType, const StepParameters& params)
         if(auto p = std::get_if<DilationParams>(&params.params))
         {
             return std::make_unique<DilationStep>(
-                p->morphShape, p->kernelSize, p->iterations);
+                p->morphShape, p->kernelSize, p->iterations, p->optimized);
         }
         break;
     }
@@ -65,7 +67,20 @@ StepFactory::createStep(StepType stepType, const StepParameters& params)
         if(auto p = std::get_if<ErosionParams>(&params.params))
         {
             return std::make_unique<ErosionStep>(
-                p->morphShape, p->kernelSize, p->iterations);
+                p->morphShape, p->kernelSize, p->iterations, p->optimized);
+        }
+        break;
+    }
+
+    case StepType::ApproxMedianBackgroundSubtraction: {
+        if(auto p = std::get_if<ApproxMedianBackgroundSubtractionParams>(
+               &params.params))
+        {
+            return std::make_unique<ApproxMedianBackgroundSubtractionStep>(
+                p->threshold,
+                p->stepSize,
+                p->updateInterval,
+                p->foregroundValue);
         }
         break;
     }
@@ -108,6 +123,7 @@ void StepFactory::serializeStepParameters(const StepParameters& params,
                 paramsNode["nMixtures"] = arg.nMixtures;
                 paramsNode["detectShadows"] = arg.detectShadows;
                 paramsNode["shadowValue"] = arg.shadowValue;
+                paramsNode["downscale"] = arg.downscale;
             }
 
             else if constexpr(std::is_same_v<T, ThresholdParams>)
@@ -123,6 +139,7 @@ void StepFactory::serializeStepParameters(const StepParameters& params,
                 // Assuming width == height
                 paramsNode["kernelSize"] = arg.kernelSize.width;
                 paramsNode["iterations"] = arg.iterations;
+                paramsNode["optimized"] = arg.optimized;
             }
 
             else if constexpr(std::is_same_v<T, ErosionParams>)
@@ -131,6 +148,16 @@ void StepFactory::serializeStepParameters(const StepParameters& params,
                 // Assuming width == height
                 paramsNode["kernelSize"] = arg.kernelSize.width;
                 paramsNode["iterations"] = arg.iterations;
+                paramsNode["optimized"] = arg.optimized;
+            }
+
+            else if constexpr(
+                std::is_same_v<T, ApproxMedianBackgroundSubtractionParams>)
+            {
+                paramsNode["threshold"] = arg.threshold;
+                paramsNode["stepSize"] = arg.stepSize;
+                paramsNode["updateInterval"] = arg.updateInterval;
+                paramsNode["foregroundValue"] = arg.foregroundValue;
             }
         },
         params.params);
@@ -177,6 +204,8 @@ StepParameters StepFactory::deserializeStepParameters(const YAML::Node& node,
             p.detectShadows = node["detectShadows"].as<bool>();
         if(node["shadowValue"])
             p.shadowValue = node["shadowValue"].as<int>();
+        if(node["downscale"])
+            p.downscale = node["downscale"].as<int>();
         params.params = p;
         break;
     }
@@ -204,6 +233,8 @@ StepParameters StepFactory::deserializeStepParameters(const YAML::Node& node,
         }
         if(node["iterations"])
             p.iterations = node["iterations"].as<int>();
+        if(node["optimized"])
+            p.optimized = node["optimized"].as<bool>();
         params.params = p;
         break;
     }
@@ -219,6 +250,22 @@ StepParameters StepFactory::deserializeStepParameters(const YAML::Node& node,
         }
         if(node["iterations"])
             p.iterations = node["iterations"].as<int>();
+        if(node["optimized"])
+            p.optimized = node["optimized"].as<bool>();
+        params.params = p;
+        break;
+    }
+
+    case StepType::ApproxMedianBackgroundSubtraction: {
+        ApproxMedianBackgroundSubtractionParams p;
+        if(node["threshold"])
+            p.threshold = node["threshold"].as<int>();
+        if(node["stepSize"])
+            p.stepSize = node["stepSize"].as<int>();
+        if(node["updateInterval"])
+            p.updateInterval = node["updateInterval"].as<int>();
+        if(node["foregroundValue"])
+            p.foregroundValue = node["foregroundValue"].as<int>();
         params.params = p;
         break;
     }
@@ -251,6 +298,8 @@ std::string StepFactory::stepTypeToString(StepType stepType)
         return "Erosion";
     case StepType::Dilation:
         return "Dilation";
+    case StepType::ApproxMedianBackgroundSubtraction:
+        return "ApproxMedianBackgroundSubtraction";
     default:
         return "Undefined";
     }
@@ -276,6 +325,8 @@ StepType StepFactory::stringToStepType(const std::string& strStepType)
         return StepType::Erosion;
     if(strStepType == "Dilation")
         return StepType::Dilation;
+    if(strStepType == "ApproxMedianBackgroundSubtraction")
+        return StepType::ApproxMedianBackgroundSubtraction;
 
     return StepType::Undefined;
 }
\ No newline at end of file
@@ -29,6 +29,8 @@ struct GaussianBlurParams
  * @param nMixtures Number of Gaussian mixtures.
  * @param detectShadows If true, the algorithm will detect shadows.
  * @param shadowValue Value to label shadow pixels in the output.
+ * @param downscale Factor (1 to 4) the frame is shrunk by for the model,
+ * the mask is scaled back up. 1 keeps the full resolution.
  */
 struct MOG2BackgroundSubtractionParams
 {
@@ -38,6 +40,7 @@ struct MOG2BackgroundSubtractionParams
     int nMixtures = 5;
     bool detectShadows = true;
     int shadowValue = 200;
+    int downscale = 1;
 };
 
 /**
@@ -58,12 +61,16 @@ struct ThresholdParams
  * @param morphShape Shape of the structuring element (i.e., enum cv::MORPH_ELLIPSE = 2).
  * @param kernelSize Size of the structuring element.
  * @param iterations Number of times dilation is applied.
+ * @param optimized If true, the iterations are collapsed into one pass of
+ * constant cost per pixel, exact for MORPH_RECT, approximated for larger
+ * iterated ellipses and crosses (see FastMorphology).
  */
 struct DilationParams
 {
     int morphShape = 2;
     cv::Size kernelSize = cv::Size(5, 5);
     int iterations = 4;
+    bool optimized = false;
 };
 
 /**
@@ -71,12 +78,34 @@ struct DilationParams
  * @param morphShape Shape of the structuring element (i.e., enum cv::MORPH_ELLIPSE = 2).
  * @param kernelSize Size of the structuring element.
  * @param iterations Number of times erosion is applied.
+ * @param optimized If true, the iterations are collapsed into one pass of
+ * constant cost per pixel, exact for MORPH_RECT, approximated for larger
+ * iterated ellipses and crosses (see FastMorphology).
  */
 struct ErosionParams
 {
     int morphShape = 2;
     cv::Size kernelSize = cv::Size(3, 3);
     int iterations = 5;
+    bool optimized = false;
+};
+
+/**
+ * @brief Parameters for Approximate Median Background Subtraction step,
+ * a lightweight alternative to MOG2.
+ * @param threshold Minimum absolute difference to the background
+ * for a pixel to be foreground.
+ * @param stepSize How much the background moves toward each frame.
+ * @param updateInterval Update the background every N frames,
+ * higher values absorb stopped vehicles slower.
+ * @param foregroundValue Value to label foreground pixels in the output.
+ */
+struct ApproxMedianBackgroundSubtractionParams
+{
+    int threshold = 30;
+    int stepSize = 1;
+    int updateInterval = 1;
+    int foregroundValue = 255;
 };
 
 /**
@@ -94,7 +123,8 @@ public:
                  MOG2BackgroundSubtractionParams,
                  ThresholdParams,
                  DilationParams,
-                 ErosionParams>
+                 ErosionParams,
+                 ApproxMedianBackgroundSubtractionParams>
         params;
 };
 
@@ -16,7 +16,10 @@ enum class StepType
     MOG2BackgroundSubtraction,
     Threshold,
     Dilation,
-    Erosion
+    Erosion,
+    ApproxMedianBackgroundSubtraction,
+
+    COUNT // number of step types, not a step
 };
 
 #endif
@@ -13,6 +13,11 @@ void ThresholdStep::process(cv::Mat& frame) const
     cv::threshold(frame, frame, thresholdValue, maxValue, thresholdType);
 }
 
+void ThresholdStep::process(const cv::Mat& input, cv::Mat& output) const
+{
+    cv::threshold(input, output, thresholdValue, maxValue, thresholdType);
+}
+
 void ThresholdStep::updateParameterById(int paramId, const std::any& value)
 {
     switch(paramId)
@@ -14,6 +14,7 @@ public:
     ThresholdStep(int thresholdValue, int maxValue, int thresholdType);
 
     void process(cv::Mat& frame) const override;
+    void process(const cv::Mat& input, cv::Mat& output) const override;
 
     void updateParameterById(int paramId, const std::any& value) override;
     void setStepParameters(const StepParameters& newParams) override;
@@ -0,0 +1,169 @@
+#ifndef STATIC_PIPELINE_H
+#define STATIC_PIPELINE_H
+
+#include "PipelineBuilder.h"
+#include "StaticSteps.h"
+#include "StepTimings.h"
+#include <string>
+#include <tuple>
+#include <utility>
+
+/**
+ * @brief Interface of the StaticPipeline specializations, so the one
+ * matching the loaded config can be selected at run time.
+ * One virtual call per frame, none per step.
+ */
+class IStaticPipeline
+{
+public:
+    virtual ~IStaticPipeline() {}
+
+    /**
+     * @brief Runs every step, same result as PipelineBuilder::process.
+     * @param input The image frame to be processed, left unchanged.
+     * @param output The processed frame.
+     */
+    virtual void process(const cv::Mat& input, cv::Mat& output) = 0;
+
+    /**
+     * @brief Describes the steps, e.g. "Grayscale -> GaussianBlur".
+     * @return The step names, in order.
+     */
+    virtual std::string getDescription() const = 0;
+
+    /**
+     * @brief Records the duration of every step per StepType.
+     * @param timings The histograms to record into, owned by the caller,
+     * nullptr to stop recording.
+     */
+    void setTimings(StepTimings* timings)
+    {
+        this->timings = timings;
+    }
+
+protected:
+    StepTimings* timings = nullptr;
+};
+
+/**
+ * @brief Preprocessing pipeline whose step sequence is fixed at compile
+ * time (see StaticSteps.h), so the whole chain is inlined: no virtual
+ * call per step, no std::any/typeid parameter handling, and constant
+ * kernel sizes. Built from a PipelineBuilder holding the same sequence,
+ * see matches and PipelineDirector::createStaticPipeline. Parameters are
+ * fixed once built, the builder remains the pipeline for live tuning.
+ */
+template<typename... Steps>
+class StaticPipeline final : public IStaticPipeline
+{
+    static_assert(sizeof...(Steps) > 0, "A pipeline needs at least one step");
+
+public:
+    explicit StaticPipeline(const PipelineBuilder& builder)
+        : StaticPipeline(builder, std::index_sequence_for<Steps...>{})
+    {}
+
+    /**
+     * @brief Checks if the builder holds this step sequence, with the
+     * compile time constants (e.g. kernel sizes) of every step.
+     * @param builder The builder, e.g. after loadPipelineConfig.
+     * @return true if the pipeline can be built from the builder.
+     */
+    static bool matches(const PipelineBuilder& builder)
+    {
+        return builder.getNumberOfSteps() == sizeof...(Steps) &&
+               matchesSteps(builder, std::index_sequence_for<Steps...>{});
+    }
+
+    void process(const cv::Mat& input, cv::Mat& output) override
+    {
+        // like the builder: the first step writes into output,
+        // the rest run in place
+        StepTimings::measure(timings, StepAt<0>::TYPE, [&] {
+            std::get<0>(steps).process(input, output);
+        });
+        processInPlace(output,
+                       std::make_index_sequence<sizeof...(Steps) - 1>{});
+    }
+
+    std::string getDescription() const override
+    {
+        std::string description;
+        ((description += (description.empty() ? "" : " -> ") +
+                         StepFactory::stepTypeToString(Steps::TYPE)),
+         ...);
+
+        return description;
+    }
+
+private:
+    std::tuple<Steps...> steps;
+
+    template<size_t Index>
+    using StepAt = std::tuple_element_t<Index, std::tuple<Steps...>>;
+
+    template<size_t... Indices>
+    StaticPipeline(const PipelineBuilder& builder,
+                   std::index_sequence<Indices...>)
+        : steps(getParams<Steps>(builder, Indices)...)
+    {}
+
+    template<typename Step>
+    static typename Step::Params getParams(const PipelineBuilder& builder,
+                                           size_t index)
+    {
+        StepParameters params = builder.getStepCurrentParameters(index);
+        auto stepParams = std::get_if<typename Step::Params>(&params.params);
+
+        return stepParams ? *stepParams : typename Step::Params{};
+    }
+
+    template<typename Step>
+    static bool matchesStep(const PipelineBuilder& builder, size_t index)
+    {
+        if(builder.getStepType(index) != Step::TYPE)
+            return false;
+
+        StepParameters params = builder.getStepCurrentParameters(index);
+        auto stepParams = std::get_if<typename Step::Params>(&params.params);
+
+        return stepParams != nullptr && Step::matches(*stepParams);
+    }
+
+    template<size_t... Indices>
+    static bool matchesSteps(const PipelineBuilder& builder,
+                             std::index_sequence<Indices...>)
+    {
+        return (matchesStep<Steps>(builder, Indices) && ...);
+    }
+
+    template<size_t... Indices>
+    void processInPlace(cv::Mat& frame, std::index_sequence<Indices...>)
+    {
+        (StepTimings::measure(timings,
+                              StepAt<Indices + 1>::TYPE,
+                              [&] {
+                                  std::get<Indices + 1>(steps).process(frame);
+                              }),
+         ...);
+    }
+};
+
+/**
+ * @brief PipelineDirector::setupDefaultPipeline, specialized.
+ */
+using DefaultStaticPipeline =
+    StaticPipeline<StaticGrayscale,
+                   StaticGaussianBlur<5>,
+                   StaticMOG2BackgroundSubtraction,
+                   StaticThreshold,
+                   StaticDilation<cv::MORPH_ELLIPSE, 5>,
+                   StaticErosion<cv::MORPH_ELLIPSE, 3>>;
+
+/**
+ * @brief The specializations PipelineDirector::createStaticPipeline
+ * tries, in order. Add a StaticPipeline here to support another config.
+ */
+using KnownStaticPipelines = std::tuple<DefaultStaticPipeline>;
+
+#endif
@@ -0,0 +1,234 @@
+#ifndef STATIC_STEPS_H
+#define STATIC_STEPS_H
+
+#include "FastMorphology.h"
+#include "StepParameters.h"
+#include "StepType.h"
+#include <algorithm>
+#include <opencv2/opencv.hpp>
+#include <type_traits>
+
+/**
+ * @brief Steps of a StaticPipeline. Same operations as the IPreprocessStep
+ * implementations, but plain types called directly, without virtual
+ * calls or std::any parameter updates. The kernel sizes are template
+ * parameters, a step only matches the configs using that size.
+ * Each step provides:
+ * - Params, TYPE: the parameters and step type it is built from.
+ * - matches(params): whether the compile time constants fit the params.
+ * - process(input, output) and process(frame), like IPreprocessStep.
+ */
+
+struct StaticGrayscale
+{
+    using Params = GrayscaleParams;
+    static constexpr StepType TYPE = StepType::Grayscale;
+
+    explicit StaticGrayscale(const Params&) {}
+
+    static bool matches(const Params&)
+    {
+        return true;
+    }
+
+    void process(const cv::Mat& input, cv::Mat& output)
+    {
+        if(input.channels() == 1)
+        {
+            input.copyTo(output);
+            return;
+        }
+        cv::cvtColor(input, output, cv::COLOR_BGR2GRAY);
+    }
+
+    void process(cv::Mat& frame)
+    {
+        if(frame.channels() != 1)
+        {
+            cv::cvtColor(frame, frame, cv::COLOR_BGR2GRAY);
+        }
+    }
+};
+
+template<int KernelSize>
+struct StaticGaussianBlur
+{
+    static_assert(KernelSize > 0 && KernelSize % 2 == 1,
+                  "Gaussian kernel size must be positive and odd");
+
+    using Params = GaussianBlurParams;
+    static constexpr StepType TYPE = StepType::GaussianBlur;
+
+    explicit StaticGaussianBlur(const Params& params)
+        : sigma(params.sigma)
+    {}
+
+    static bool matches(const Params& params)
+    {
+        return params.kernelSize == KernelSize;
+    }
+
+    void process(const cv::Mat& input, cv::Mat& output)
+    {
+        cv::GaussianBlur(
+            input, output, cv::Size(KernelSize, KernelSize), sigma);
+    }
+
+    void process(cv::Mat& frame)
+    {
+        process(frame, frame);
+    }
+
+    double sigma;
+};
+
+struct StaticMOG2BackgroundSubtraction
+{
+    using Params = MOG2BackgroundSubtractionParams;
+    static constexpr StepType TYPE = StepType::MOG2BackgroundSubtraction;
+
+    explicit StaticMOG2BackgroundSubtraction(const Params& params)
+        : bgSubtractor(cv::createBackgroundSubtractorMOG2())
+        , downscale(std::clamp(params.downscale, 1, 4))
+    {
+        bgSubtractor->setHistory(params.history);
+        bgSubtractor->setVarThreshold(params.varThreshold);
+        bgSubtractor->setVarThresholdGen(params.varThresholdGen);
+        bgSubtractor->setNMixtures(params.nMixtures);
+        bgSubtractor->setDetectShadows(params.detectShadows);
+        bgSubtractor->setShadowValue(params.shadowValue);
+    }
+
+    static bool matches(const Params&)
+    {
+        return true;
+    }
+
+    void process(const cv::Mat& input, cv::Mat& output)
+    {
+        if(downscale == 1)
+        {
+            bgSubtractor->apply(input, output);
+            return;
+        }
+
+        // same as MOG2BackgroundSubtractionStep
+        cv::Size smallSize((input.cols + downscale - 1) / downscale,
+                           (input.rows + downscale - 1) / downscale);
+        cv::resize(input, smallFrame, smallSize, 0, 0, cv::INTER_AREA);
+        bgSubtractor->apply(smallFrame, smallMask);
+        cv::resize(smallMask, output, input.size(), 0, 0, cv::INTER_NEAREST);
+    }
+
+    void process(cv::Mat& frame)
+    {
+        process(frame, frame);
+    }
+
+    cv::Ptr<cv::BackgroundSubtractorMOG2> bgSubtractor;
+    int downscale;
+    cv::Mat smallFrame;
+    cv::Mat smallMask;
+};
+
+struct StaticThreshold
+{
+    using Params = ThresholdParams;
+    static constexpr StepType TYPE = StepType::Threshold;
+
+    explicit StaticThreshold(const Params& params)
+        : params(params)
+    {}
+
+    static bool matches(const Params&)
+    {
+        return true;
+    }
+
+    void process(const cv::Mat& input, cv::Mat& output)
+    {
+        cv::threshold(input,
+                      output,
+                      params.thresholdValue,
+                      params.maxValue,
+                      params.thresholdType);
+    }
+
+    void process(cv::Mat& frame)
+    {
+        process(frame, frame);
+    }
+
+    Params params;
+};
+
+/**
+ * @brief Dilation (cv::MORPH_DILATE) or erosion (cv::MORPH_ERODE) with a
+ * structuring element of compile time shape and size, built once.
+ */
+template<int Operation, int MorphShape, int KernelSize>
+struct StaticMorphology
+{
+    static_assert(Operation == cv::MORPH_DILATE || Operation == cv::MORPH_ERODE,
+                  "Only dilation and erosion are supported");
+    static_assert(KernelSize > 0, "Kernel size must be positive");
+
+    static constexpr bool IS_DILATION = (Operation == cv::MORPH_DILATE);
+
+    using Params =
+        std::conditional_t<IS_DILATION, DilationParams, ErosionParams>;
+    static constexpr StepType TYPE =
+        IS_DILATION ? StepType::Dilation : StepType::Erosion;
+
+    explicit StaticMorphology(const Params& params)
+        : kernel(cv::getStructuringElement(MorphShape,
+                                           cv::Size(KernelSize, KernelSize)))
+        , iterations(params.iterations)
+        , optimized(params.optimized)
+        , fastMorphology(Operation)
+    {
+        fastMorphology.setStructuringElement(
+            MorphShape, cv::Size(KernelSize, KernelSize), iterations);
+    }
+
+    static bool matches(const Params& params)
+    {
+        return params.morphShape == MorphShape &&
+               params.kernelSize == cv::Size(KernelSize, KernelSize);
+    }
+
+    void process(const cv::Mat& input, cv::Mat& output)
+    {
+        if(optimized)
+        {
+            fastMorphology.apply(input, output);
+        }
+        else if constexpr(IS_DILATION)
+        {
+            cv::dilate(input, output, kernel, cv::Point(-1, -1), iterations);
+        }
+        else
+        {
+            cv::erode(input, output, kernel, cv::Point(-1, -1), iterations);
+        }
+    }
+
+    void process(cv::Mat& frame)
+    {
+        process(frame, frame);
+    }
+
+    cv::Mat kernel;
+    int iterations;
+    bool optimized;
+    FastMorphology fastMorphology;
+};
+
+template<int MorphShape, int KernelSize>
+using StaticDilation =
+    StaticMorphology<cv::MORPH_DILATE, MorphShape, KernelSize>;
+
+template<int MorphShape, int KernelSize>
+using StaticErosion = StaticMorphology<cv::MORPH_ERODE, MorphShape, KernelSize>;
+
+#endif
@@ -0,0 +1,165 @@
+#include "StepTimings.h"
+#include "StepFactory.h"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+
+/**
+ * @brief Adds one sample to the histogram of a step type.
+ * @param type the step type, Undefined and COUNT are ignored.
+ * @param nanoseconds the duration of the step.
+ */
+void StepTimings::record(StepType type, uint64_t nanoseconds)
+{
+    size_t index = static_cast<size_t>(type);
+    if(type == StepType::Undefined || index >= STEP_TYPE_COUNT)
+        return;
+
+    Histogram& histogram = histograms[index];
+    histogram.buckets[getBucket(nanoseconds)].fetch_add(
+        1, std::memory_order_relaxed);
+    histogram.count.fetch_add(1, std::memory_order_relaxed);
+    histogram.totalNs.fetch_add(nanoseconds, std::memory_order_relaxed);
+
+    uint64_t maxNs = histogram.maxNs.load(std::memory_order_relaxed);
+    while(nanoseconds > maxNs &&
+          !histogram.maxNs.compare_exchange_weak(
+              maxNs, nanoseconds, std::memory_order_relaxed))
+    {
+    }
+}
+
+/**
+ * @brief Empties all the histograms, e.g. to start a new report period.
+ * Samples recorded concurrently may be split across both periods.
+ */
+void StepTimings::reset()
+{
+    for(auto& histogram : histograms)
+    {
+        for(auto& bucket : histogram.buckets)
+        {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+        histogram.count.store(0, std::memory_order_relaxed);
+        histogram.totalNs.store(0, std::memory_order_relaxed);
+        histogram.maxNs.store(0, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief Summarizes the histogram of a step type.
+ * @param type the step type.
+ * @return the sample count and latencies, all zero without samples.
+ */
+StepTimingSummary StepTimings::getSummary(StepType type) const
+{
+    StepTimingSummary summary;
+
+    size_t index = static_cast<size_t>(type);
+    if(type == StepType::Undefined || index >= STEP_TYPE_COUNT)
+        return summary;
+
+    const Histogram& histogram = histograms[index];
+    summary.count = histogram.count.load(std::memory_order_relaxed);
+    if(summary.count == 0)
+        return summary;
+
+    summary.meanMs = histogram.totalNs.load(std::memory_order_relaxed) /
+                     1e6 / summary.count;
+    summary.maxMs = histogram.maxNs.load(std::memory_order_relaxed) / 1e6;
+    summary.p50Ms =
+        getPercentileMs(histogram, summary.count, 0.50, summary.maxMs);
+    summary.p99Ms =
+        getPercentileMs(histogram, summary.count, 0.99, summary.maxMs);
+
+    return summary;
+}
+
+/**
+ * @brief Formats the summary of every step type with samples,
+ * one line per step type.
+ * @return the report, empty without samples.
+ */
+std::string StepTimings::getReport() const
+{
+    std::ostringstream report;
+    report << std::fixed << std::setprecision(3);
+
+    for(size_t i = 0; i < STEP_TYPE_COUNT; ++i)
+    {
+        StepType type = static_cast<StepType>(i);
+        StepTimingSummary summary = getSummary(type);
+        if(summary.count == 0)
+            continue;
+
+        report << "  " << StepFactory::stepTypeToString(type)
+               << ": n=" << summary.count << " mean=" << summary.meanMs
+               << " ms p50<=" << summary.p50Ms << " ms p99<=" << summary.p99Ms
+               << " ms max=" << summary.maxMs << " ms\n";
+    }
+
+    return report.str();
+}
+
+/**
+ * @brief Time since a start point, in nanoseconds.
+ * @param start the start point, from Clock::now.
+ * @return the elapsed nanoseconds.
+ */
+uint64_t StepTimings::getElapsedNs(Clock::time_point start)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() -
+                                                                start)
+        .count();
+}
+
+/**
+ * @brief Finds the bucket of a duration, the number of bits of its
+ * microseconds, so bucket b holds [2^(b-1), 2^b) microseconds.
+ * @param nanoseconds the duration.
+ * @return the bucket index, the last one for longer durations.
+ */
+size_t StepTimings::getBucket(uint64_t nanoseconds)
+{
+    uint64_t microseconds = nanoseconds / 1000;
+
+    size_t bucket = 0;
+    while(microseconds > 0 && bucket < BUCKET_COUNT - 1)
+    {
+        microseconds >>= 1;
+        ++bucket;
+    }
+
+    return bucket;
+}
+
+/**
+ * @brief Finds the bucket holding a percentile of the samples.
+ * @param histogram the histogram of a step type.
+ * @param count the sample count, read once by the caller.
+ * @param percentile in [0, 1].
+ * @param maxMs the longest sample, bounds the last buckets.
+ * @return the upper bound of the bucket, in milliseconds.
+ */
+double StepTimings::getPercentileMs(const Histogram& histogram,
+                                    uint64_t count,
+                                    double percentile,
+                                    double maxMs)
+{
+    uint64_t rank = static_cast<uint64_t>(std::ceil(percentile * count));
+    uint64_t cumulative = 0;
+
+    for(size_t bucket = 0; bucket < BUCKET_COUNT - 1; ++bucket)
+    {
+        cumulative += histogram.buckets[bucket].load(std::memory_order_relaxed);
+        if(cumulative >= rank)
+        {
+            double upperMs = static_cast<double>(uint64_t(1) << bucket) / 1e3;
+            return std::min(upperMs, maxMs);
+        }
+    }
+
+    return maxMs;
+}
@@ -0,0 +1,89 @@
+#ifndef STEP_TIMINGS_H
+#define STEP_TIMINGS_H
+
+#include "StepType.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief Latency summary of one step type, percentiles are the upper
+ * bound of their histogram bucket (at most the maximum).
+ */
+struct StepTimingSummary
+{
+    uint64_t count = 0;
+    double meanMs = 0;
+    double p50Ms = 0;
+    double p99Ms = 0;
+    double maxMs = 0;
+};
+
+/**
+ * @brief Per step latency histograms, keyed by StepType. Recording is
+ * lock-free (relaxed atomics), so the parallel bands and the pipelined
+ * stages record concurrently, and the watcher reads at any time.
+ * The pipelines only hold a pointer to it, null when disabled, so the
+ * disabled cost is a branch per step, without reading the clock.
+ * The buckets are powers of two microseconds.
+ */
+class StepTimings
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    void record(StepType type, uint64_t nanoseconds);
+    void reset();
+
+    StepTimingSummary getSummary(StepType type) const;
+    std::string getReport() const;
+
+    static uint64_t getElapsedNs(Clock::time_point start);
+
+    /**
+     * @brief Runs the work, and records its duration if timings is set.
+     * @param timings the histograms to record into, nullptr to disable.
+     * @param type the step type the work is recorded under.
+     * @param work the step call.
+     */
+    template<typename Work>
+    static void measure(StepTimings* timings, StepType type, Work&& work)
+    {
+        if(timings == nullptr)
+        {
+            work();
+            return;
+        }
+
+        Clock::time_point start = Clock::now();
+        work();
+        timings->record(type, getElapsedNs(start));
+    }
+
+private:
+    static constexpr size_t STEP_TYPE_COUNT =
+        static_cast<size_t>(StepType::COUNT);
+
+    // [0, 1us), [1us, 2us), [2us, 4us)... the last one is open ended
+    static constexpr size_t BUCKET_COUNT = 24;
+
+    struct Histogram
+    {
+        std::array<std::atomic<uint64_t>, BUCKET_COUNT> buckets{};
+        std::atomic<uint64_t> count{0};
+        std::atomic<uint64_t> totalNs{0};
+        std::atomic<uint64_t> maxNs{0};
+    };
+
+    std::array<Histogram, STEP_TYPE_COUNT> histograms;
+
+    static size_t getBucket(uint64_t nanoseconds);
+    static double getPercentileMs(const Histogram& histogram,
+                                  uint64_t count,
+                                  double percentile,
+                                  double maxMs);
+};
+
+#endif
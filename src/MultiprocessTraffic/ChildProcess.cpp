@@ -65,6 +65,8 @@ void ChildProcess::runVehicle(bool debug,
         }
         else
         {
+            // keep the stream fresh for the next phase message
+            vehicleWatcher->idle();
             usleep(CPU_SLEEP_US);
         }
     }
@@ -92,6 +94,8 @@ void ChildProcess::runPedestrian(bool debug,
         processMessageBuffer(
             bytesRead, buffer, isStateGreen, pedestrianWatcher);
 
+        // keep the stream fresh for the next phase message
+        pedestrianWatcher->idle();
         usleep(CPU_SLEEP_US);
     }
 
@@ -152,7 +156,8 @@ void ChildProcess::handlePhaseMessage(PhaseMessageType phaseType,
         // send the previous green vehicle density
         float density = watcher->getTrafficDensity();
 
-        sendPhaseMessageToParent(density, speed, vehicles);
+        sendPhaseMessageToParent(
+            density, speed, watcher->isStreamDegraded(), vehicles);
 
         isStateGreen = false;
         watcher->setCurrentTrafficState(TrafficState::RED_PHASE);
@@ -169,7 +174,8 @@ void ChildProcess::handlePhaseMessage(PhaseMessageType phaseType,
         watcher->processFrame();
         float density = watcher->getTrafficDensity();
 
-        sendPhaseMessageToParent(density, speed, vehicles);
+        sendPhaseMessageToParent(
+            density, speed, watcher->isStreamDegraded(), vehicles);
 
         isStateGreen = true;
         watcher->setCurrentTrafficState(TrafficState::GREEN_PHASE);
@@ -180,14 +186,14 @@ void ChildProcess::handlePhaseMessage(PhaseMessageType phaseType,
         // send the waiting pedestrian count
         watcher->processFrame();
         float density = watcher->getInstanceCount();
-        sendPhaseMessageToParent(density, 0.0f);
+        sendPhaseMessageToParent(density, 0.0f, watcher->isStreamDegraded());
 
         break;
     }
 
     case GREEN_PED: {
         // ignore the already walking pedestrian
-        sendPhaseMessageToParent(0.0f, 0.0f);
+        sendPhaseMessageToParent(0.0f, 0.0f, watcher->isStreamDegraded());
 
         break;
     }
@@ -201,7 +207,10 @@ void ChildProcess::handlePhaseMessage(PhaseMessageType phaseType,
 }
 
 void ChildProcess::sendPhaseMessageToParent(
-    float density, float speed, std::unordered_map<std::string, int> vehicles)
+    float density,
+    float speed,
+    bool streamDegraded,
+    std::unordered_map<std::string, int> vehicles)
 {
     char buffer[BUFFER_SIZE] = {0};
     int offset = 0;
@@ -227,6 +236,19 @@ void ChildProcess::sendPhaseMessageToParent(
     }
     offset += written;
 
+    // Stream status, the parent ignores the values of a degraded stream
+    written = snprintf(buffer + offset,
+                       BUFFER_SIZE - offset,
+                       "%s;",
+                       streamDegraded ? "DEGRADED" : "OK");
+    if(written < 0 || written >= BUFFER_SIZE - offset)
+    {
+        std::cerr << "Child " << childIndex
+                  << ": Buffer overflow while writing stream status.\n";
+        return;
+    }
+    offset += written;
+
     // Convert vehicle counts to string
     std::ostringstream oss;
     for(const auto& entry : vehicles)
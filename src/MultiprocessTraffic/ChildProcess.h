@@ -52,6 +52,7 @@ private:
     void sendPhaseMessageToParent(
         float density,
         float speed,
+        bool streamDegraded,
         std::unordered_map<std::string, int> vehicles = {});
 
     void closeUnusedPipes();
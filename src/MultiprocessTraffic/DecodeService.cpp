@@ -0,0 +1,166 @@
+#include "DecodeService.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+DecodeService::DecodeService(const std::vector<std::string>& streamLinks,
+                             const std::vector<std::string>& sharedNames,
+                             int threadCount,
+                             bool verbose)
+    : verbose(verbose)
+    , threadCount(std::clamp(threadCount, 1, int(streamLinks.size())))
+{
+    for(size_t i = 0; i < streamLinks.size(); ++i)
+    {
+        auto stream = std::make_unique<DecodedStream>();
+        stream->link = streamLinks[i];
+        stream->sharedName = sharedNames[i];
+        streams.push_back(std::move(stream));
+    }
+}
+
+std::string DecodeService::getSharedName(int junctionId, int streamIndex)
+{
+    return "traffic_j" + std::to_string(junctionId) + "_stream" +
+           std::to_string(streamIndex);
+}
+
+void DecodeService::run()
+{
+    // one FFmpeg decoder thread per stream, the pool bounds the total
+    setenv("OPENCV_FFMPEG_CAPTURE_OPTIONS", "threads;1", 0);
+
+    for(size_t i = 0; i < streams.size(); ++i)
+    {
+        if(!openStream(i))
+        {
+            std::cerr << "Error: Decode service unable to open stream "
+                      << streams[i]->sharedName << "\n";
+            exit(EXIT_FAILURE);
+        }
+
+        readyStreams.push({Clock::now(), i});
+    }
+
+    if(verbose)
+    {
+        std::cout << "Decode service: " << streams.size() << " streams, "
+                  << threadCount << " threads\n";
+    }
+
+    std::vector<std::thread> workers;
+    for(int i = 0; i < threadCount; ++i)
+    {
+        workers.emplace_back(&DecodeService::decodeLoop, this);
+    }
+
+    for(auto& worker : workers)
+    {
+        worker.join();
+    }
+}
+
+bool DecodeService::openStream(size_t index)
+{
+    DecodedStream& stream = *streams[index];
+
+    stream.capture.open(stream.link);
+    if(!stream.capture.isOpened() || !stream.capture.read(stream.frame) ||
+       stream.frame.empty())
+    {
+        return false;
+    }
+
+    double framesPerSec = stream.capture.get(cv::CAP_PROP_FPS);
+    if(framesPerSec == 0.0)
+    {
+        framesPerSec = 30.0;
+    }
+
+    // the segment size is only known after the first frame
+    if(!stream.buffer.create(stream.sharedName,
+                             stream.frame.size(),
+                             stream.frame.type(),
+                             framesPerSec))
+    {
+        return false;
+    }
+
+    stream.buffer.write(stream.frame,
+                        stream.capture.get(cv::CAP_PROP_POS_MSEC));
+    return true;
+}
+
+void DecodeService::decodeLoop()
+{
+    while(true)
+    {
+        size_t index;
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            while(true)
+            {
+                streamAvailable.wait(lock,
+                                     [this] { return !readyStreams.empty(); });
+
+                Clock::time_point dueTime = readyStreams.top().dueTime;
+                if(Clock::now() >= dueTime)
+                    break;
+
+                // woken earlier if a stream due sooner is pushed
+                streamAvailable.wait_until(lock, dueTime);
+            }
+
+            index = readyStreams.top().index;
+            readyStreams.pop();
+        }
+
+        // only one worker owns a stream at a time
+        Clock::duration delay = decodeNextFrame(*streams[index]);
+
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            readyStreams.push({Clock::now() + delay, index});
+        }
+        streamAvailable.notify_one();
+    }
+}
+
+DecodeService::Clock::duration
+DecodeService::decodeNextFrame(DecodedStream& stream)
+{
+    // never sleeps, returns the delay until the stream is due again
+    if(stream.reopenPending)
+    {
+        if(!stream.capture.open(stream.link) || !stream.capture.isOpened())
+        {
+            std::cerr << "Warning: Unable to reopen stream "
+                      << stream.sharedName << ", retrying.\n";
+            stream.capture.release();
+            return std::chrono::milliseconds(REOPEN_DELAY_MS);
+        }
+
+        stream.reopenPending = false;
+        stream.emptyFrames = 0;
+    }
+
+    if(stream.capture.read(stream.frame) && !stream.frame.empty())
+    {
+        stream.emptyFrames = 0;
+        stream.buffer.write(stream.frame,
+                            stream.capture.get(cv::CAP_PROP_POS_MSEC));
+        return Clock::duration::zero();
+    }
+
+    if(++stream.emptyFrames < MAX_EMPTY_FRAMES)
+        return std::chrono::milliseconds(EMPTY_FRAME_DELAY_MS);
+
+    // the watchers keep waiting on the shared buffer meanwhile
+    std::cerr << "Warning: Too many missing frames, reopening stream "
+              << stream.sharedName << "\n";
+
+    stream.capture.release();
+    stream.reopenPending = true;
+    return std::chrono::milliseconds(REOPEN_DELAY_MS);
+}
@@ -0,0 +1,84 @@
+#ifndef DECODE_SERVICE_H
+#define DECODE_SERVICE_H
+
+#include "SharedFrameBuffer.h"
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <opencv2/opencv.hpp>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Optional process decoding every stream of the junction with one
+ * bounded thread pool, instead of one capture (and FFmpeg thread pool)
+ * per watcher. Each decoded frame is published to the SharedFrameBuffer
+ * of its stream, which the watchers read as "shm://<name>" links.
+ * Enabled with "decodeService: true" in the junction config.
+ */
+class DecodeService
+{
+public:
+    DecodeService(const std::vector<std::string>& streamLinks,
+                  const std::vector<std::string>& sharedNames,
+                  int threadCount,
+                  bool verbose = false);
+
+    void run();
+
+    static std::string getSharedName(int junctionId, int streamIndex);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr int MAX_EMPTY_FRAMES = 30;
+    static constexpr int REOPEN_DELAY_MS = 1000;
+    static constexpr int EMPTY_FRAME_DELAY_MS = 10;
+
+    struct DecodedStream
+    {
+        std::string link;
+        std::string sharedName;
+        cv::VideoCapture capture;
+        SharedFrameBuffer buffer;
+        cv::Mat frame;
+        int emptyFrames = 0;
+        bool reopenPending = false;
+    };
+
+    // a stream waiting to be decoded, from the time it is due
+    struct ScheduledStream
+    {
+        Clock::time_point dueTime;
+        size_t index;
+
+        bool operator>(const ScheduledStream& other) const
+        {
+            return dueTime > other.dueTime;
+        }
+    };
+
+    bool verbose;
+    int threadCount;
+
+    std::vector<std::unique_ptr<DecodedStream>> streams;
+
+    // earliest due first, a stream waiting for a retry does not hold
+    // a worker, the other streams are decoded meanwhile
+    std::priority_queue<ScheduledStream,
+                        std::vector<ScheduledStream>,
+                        std::greater<ScheduledStream>>
+        readyStreams;
+    std::mutex queueMutex;
+    std::condition_variable streamAvailable;
+
+    bool openStream(size_t index);
+    void decodeLoop();
+    Clock::duration decodeNextFrame(DecodedStream& stream);
+};
+
+#endif
@@ -1,6 +1,7 @@
 #include "MultiprocessTraffic.h"
 #include "Reports.h"
 #include "TelnetRelayController.h"
+#include <algorithm>
 #include <chrono>
 #include <csignal>
 #include <cstring>
@@ -34,6 +35,12 @@ MultiprocessTraffic::MultiprocessTraffic(const std::string& configFile,
 void MultiprocessTraffic::start()
 {
     createPipes();
+
+    if(useDecodeService)
+    {
+        forkDecodeService();
+    }
+
     forkChildren();
 
     ParentProcess parentProcess(numVehicle,
@@ -211,6 +218,56 @@ void MultiprocessTraffic::forkChildren()
     }
 }
 
+void MultiprocessTraffic::forkDecodeService()
+{
+    std::vector<std::string> sharedNames;
+    for(int i = 0; i < numChildren; ++i)
+    {
+        sharedNames.push_back(DecodeService::getSharedName(junctionId, i));
+        // a segment left by a killed run would look ready to the watchers
+        SharedFrameBuffer::unlink(sharedNames.back());
+    }
+
+    pid_t pid = fork();
+    if(pid < 0)
+    {
+        std::cerr << "Fork failed: " << strerror(errno) << "\n";
+        exit(EXIT_FAILURE);
+    }
+    else if(pid == 0)
+    {
+        // the parent handlers would turn off the relays and restart the
+        // children, Ctrl-C (sent to the whole group) only ends the service
+        std::signal(SIGINT, SIG_DFL);
+        std::signal(SIGCHLD, SIG_DFL);
+
+        for(int i = 0; i < numChildren; ++i)
+        {
+            close(pipesParentToChild[i].fds[0]);
+            close(pipesParentToChild[i].fds[1]);
+            close(pipesChildToParent[i].fds[0]);
+            close(pipesChildToParent[i].fds[1]);
+        }
+
+        DecodeService decodeService(
+            streamLinks, sharedNames, decodeThreads, verbose);
+        decodeService.run();
+        exit(EXIT_SUCCESS);
+    }
+
+    childPids.push_back(pid);
+    if(verbose)
+    {
+        std::cout << "Decode Service PID: " << pid << "\n";
+    }
+
+    // the watchers now read the decoded frames from shared memory
+    for(int i = 0; i < numChildren; ++i)
+    {
+        streamLinks[i] = SharedFrameBuffer::LINK_PREFIX + sharedNames[i];
+    }
+}
+
 void MultiprocessTraffic::calibrate()
 {
     WatcherSpawner spawner;
@@ -238,6 +295,7 @@ void MultiprocessTraffic::loadJunctionConfig()
     loadStreamInfo(config);
     loadRelayInfo(config);
     loadHttpInfo(config);
+    loadDecodeServiceInfo(config);
 
     setVehicleAndPedestrianCount();
     setYellowChannels(config);
@@ -285,6 +343,23 @@ void MultiprocessTraffic::loadHttpInfo(const YAML::Node& config)
     }
 }
 
+void MultiprocessTraffic::loadDecodeServiceInfo(const YAML::Node& config)
+{
+    // optional, each watcher decodes its own stream if not specified
+    useDecodeService =
+        config["decodeService"] && config["decodeService"].as<bool>();
+
+    if(config["decodeThreads"] && config["decodeThreads"].IsScalar())
+    {
+        decodeThreads = config["decodeThreads"].as<int>();
+    }
+    else
+    {
+        decodeThreads =
+            std::max(1, int(std::thread::hardware_concurrency() / 2));
+    }
+}
+
 void MultiprocessTraffic::loadPhases(const YAML::Node& config)
 {
     if(!config["phases"])
@@ -2,6 +2,7 @@
 #define MULTIPROCESS_TRAFFIC_H
 
 #include "ChildProcess.h"
+#include "DecodeService.h"
 #include "ParentProcess.h"
 #include "PhaseMessageType.h"
 #include "Pipe.h"
@@ -40,6 +41,9 @@ private:
     int minPedestrianDurationMs;
     int standbyDuration;
 
+    bool useDecodeService;
+    int decodeThreads;
+
     std::vector<pid_t> childPids;
     std::vector<Pipe> pipesParentToChild;
     std::vector<Pipe> pipesChildToParent;
@@ -64,6 +68,7 @@ private:
 
     void createPipes();
     void forkChildren();
+    void forkDecodeService();
 
     void loadJunctionConfig();
     void loadPhases(const YAML::Node& config);
@@ -73,6 +78,7 @@ private:
     void loadRelayInfo(const YAML::Node& config);
     void loadJunctionInfo(const YAML::Node& config);
     void loadHttpInfo(const YAML::Node& config);
+    void loadDecodeServiceInfo(const YAML::Node& config);
 
     void setVehicleAndPedestrianCount();
     int calculateTotalChannels(const std::vector<std::string>& childrenPhases);
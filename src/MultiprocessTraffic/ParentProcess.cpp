@@ -169,12 +169,23 @@ bool ParentProcess::receivePrevDataFromChildren(
     {
         float density;
         float speed;
+        bool streamDegraded;
         std::unordered_map<std::string, int> vehicles;
-        if(!readDataFromChild(i, density, speed, vehicles))
+        if(!readDataFromChild(i, density, speed, streamDegraded, vehicles))
         {
             return false;
         }
 
+        if(streamDegraded)
+        {
+            // the child is reconnecting its stream, keep the values
+            // of its last cycle instead of putting the junction on standby
+            std::cerr << "Parent: Stream of child " << i
+                      << " is degraded, keeping its previous density: "
+                      << phaseDensities[previousPhaseIndex][i] << "\n";
+            continue;
+        }
+
         PhaseMessageType previousPhaseType = phases[previousPhaseIndex][i];
         processDensityByPhaseType(previousPhaseType, density);
         density = std::clamp(density, densityMin, densityMax);
@@ -196,6 +207,7 @@ bool ParentProcess::readDataFromChild(
     int childIndex,
     float& density,
     float& speed,
+    bool& streamDegraded,
     std::unordered_map<std::string, int>& vehicles)
 {
     char buffer[BUFFER_SIZE];
@@ -211,12 +223,14 @@ bool ParentProcess::readDataFromChild(
 
     std::string data(buffer);
 
-    // Locate the first and second semicolons
+    // Locate the first, second and third semicolons
     auto firstDelimiterPos = data.find(';');
     auto secondDelimiterPos = data.find(';', firstDelimiterPos + 1);
+    auto thirdDelimiterPos = data.find(';', secondDelimiterPos + 1);
 
     if(firstDelimiterPos == std::string::npos ||
-       secondDelimiterPos == std::string::npos)
+       secondDelimiterPos == std::string::npos ||
+       thirdDelimiterPos == std::string::npos)
     {
         std::cerr << "Parent: Invalid format received from child " << childIndex
                   << "\n";
@@ -263,8 +277,13 @@ bool ParentProcess::readDataFromChild(
                   << childIndex << "\n";
     }
 
+    // Parse stream status
+    streamDegraded = data.substr(secondDelimiterPos + 1,
+                                 thirdDelimiterPos - secondDelimiterPos - 1) ==
+                     "DEGRADED";
+
     // Parse vehicle data
-    std::string vehicleData = data.substr(secondDelimiterPos + 1);
+    std::string vehicleData = data.substr(thirdDelimiterPos + 1);
 
     if(!vehicleData.empty())
     {
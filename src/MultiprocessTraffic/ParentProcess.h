@@ -78,6 +78,7 @@ private:
     bool readDataFromChild(int childIndex,
                            float& density,
                            float& speed,
+                           bool& streamDegraded,
                            std::unordered_map<std::string, int>& vehicles);
 
     void processDensityByPhaseType(PhaseMessageType phaseType, float& density);
@@ -0,0 +1,580 @@
+#include "PipelineAutotuner.h"
+#include "PipelineDirector.h"
+#include "VideoStreamer.h"
+#include "WatcherSpawner.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <sstream>
+#include <thread>
+#include <unistd.h>
+
+PipelineAutotuner::PipelineAutotuner(int jobs)
+    : jobs(jobs > 0 ? jobs : cv::getNumberOfCPUs())
+    , maxFrameMs(0)
+{}
+
+/**
+ * @brief Loads the tuning spec: the clips with their ground truth, the
+ * values to sweep, the optional frame time budget and the output file.
+ * @param yamlFilename The spec file, see sample_configs/autotune.yaml.
+ * @return true if the spec has at least one valid clip.
+ */
+bool PipelineAutotuner::loadSpec(const std::string& yamlFilename)
+{
+    YAML::Node root;
+    try
+    {
+        root = YAML::LoadFile(yamlFilename);
+    }
+    catch(const YAML::Exception& ex)
+    {
+        std::cerr << "Error loading YAML file '" << yamlFilename
+                  << "': " << ex.what() << "\n";
+        return false;
+    }
+
+    const YAML::Node& clipsNode = root["clips"];
+    if(!clipsNode || !clipsNode.IsSequence())
+    {
+        std::cerr << "Error: No clips found in " << yamlFilename << ".\n";
+        return false;
+    }
+
+    clips.clear();
+    for(const auto& clipNode : clipsNode)
+    {
+        if(!clipNode["video"] || !clipNode["calibration"] ||
+           !clipNode["ground_truth_count"])
+        {
+            std::cerr << "Error: A clip needs a video, a calibration and a "
+                         "ground_truth_count, skipping it.\n";
+            continue;
+        }
+
+        TuningClip clip;
+        clip.videoFile = clipNode["video"].as<std::string>();
+        clip.calibFile = clipNode["calibration"].as<std::string>();
+        clip.groundTruthCount = clipNode["ground_truth_count"].as<int>();
+        if(clipNode["frames"])
+            clip.frames = clipNode["frames"].as<int>();
+
+        clips.push_back(clip);
+    }
+
+    if(clips.empty())
+    {
+        std::cerr << "Error: No valid clip in " << yamlFilename << ".\n";
+        return false;
+    }
+
+    // optional, a parameter missing from the sweep keeps its clip value
+    const YAML::Node& sweepNode = root["sweep"];
+    gaussianKernelSizes = readSweep(sweepNode, "gaussian_kernel_size", -1);
+    mog2Histories = readSweep(sweepNode, "mog2_history", -1);
+    dilationIterations = readSweep(sweepNode, "dilation_iterations", -1);
+    erosionIterations = readSweep(sweepNode, "erosion_iterations", -1);
+    processingScales = readSweep(sweepNode, "processing_scale", 0.0);
+
+    // optional, the most accurate point is chosen if not specified
+    maxFrameMs = root["max_frame_ms"] ? root["max_frame_ms"].as<double>() : 0;
+
+    // optional, the calibration of the first clip is updated if not specified
+    outputFile = root["output"] ? root["output"].as<std::string>()
+                                : clips.front().calibFile;
+
+    return true;
+}
+
+/**
+ * @brief Evaluates every candidate of the sweep on every clip, spread
+ * over the jobs, then marks the Pareto front.
+ */
+void PipelineAutotuner::run()
+{
+    std::vector<TuningCandidate> candidates = buildCandidates();
+    results.assign(candidates.size(), TuningResult());
+
+    // parallel across the candidates, not inside a candidate
+    cv::setNumThreads(1);
+
+    // one directory per run, so concurrent runs do not share files
+    namespace fs = std::filesystem;
+    std::error_code error;
+    fs::path tempPath = fs::temp_directory_path(error) /
+                        ("autotune_" + std::to_string(getpid()));
+    fs::create_directories(tempPath, error);
+    if(error)
+    {
+        std::cerr << "Error: Unable to create the temporary directory "
+                  << tempPath << ": " << error.message() << "\n";
+        results.clear();
+        return;
+    }
+    tempDir = tempPath.string();
+
+    std::cout << "Evaluating " << candidates.size() << " candidates on "
+              << clips.size() << " clips with " << jobs << " jobs...\n";
+
+    std::atomic<size_t> nextCandidate{0};
+    std::atomic<size_t> doneCandidates{0};
+    auto worker = [&] {
+        for(size_t i = nextCandidate++; i < candidates.size();
+            i = nextCandidate++)
+        {
+            results[i] = evaluate(candidates[i], i);
+
+            // one write per line, the workers print concurrently
+            std::string progress = "[" + std::to_string(++doneCandidates) +
+                                   "/" + std::to_string(candidates.size()) +
+                                   "] " + describe(results[i]) + "\n";
+            std::cout << progress;
+        }
+    };
+
+    std::vector<std::thread> workers;
+    size_t workerCount = std::min<size_t>(jobs, candidates.size());
+    for(size_t i = 0; i < workerCount; ++i)
+    {
+        workers.emplace_back(worker);
+    }
+    for(auto& thread : workers)
+    {
+        thread.join();
+    }
+
+    fs::remove_all(tempPath, error);
+
+    markParetoFront();
+}
+
+/**
+ * @brief Prints the Pareto optimal candidates, fastest first.
+ */
+void PipelineAutotuner::printParetoFront() const
+{
+    std::vector<const TuningResult*> front;
+    for(const auto& result : results)
+    {
+        if(result.isParetoOptimal)
+            front.push_back(&result);
+    }
+
+    std::sort(front.begin(),
+              front.end(),
+              [](const TuningResult* a, const TuningResult* b) {
+                  return a->msPerFrame < b->msPerFrame;
+              });
+
+    std::cout << "\nPareto front (" << front.size() << " of "
+              << results.size() << " candidates):\n";
+    for(const auto* result : front)
+    {
+        std::cout << "  " << describe(*result) << "\n";
+    }
+}
+
+/**
+ * @brief Saves the chosen candidate to the output calibration, the
+ * pipeline through PipelineDirector::savePipelineConfig, starting from
+ * the pipeline of the first clip, and the processing scale next to it.
+ * A new output file starts as a copy of the first clip calibration,
+ * so a watcher can load it.
+ * @return true if a candidate was chosen and saved.
+ */
+bool PipelineAutotuner::saveChosenConfig()
+{
+    const TuningResult* chosen = chooseResult();
+    if(chosen == nullptr)
+    {
+        std::cerr << "Error: No candidate to save.\n";
+        return false;
+    }
+
+    std::cout << "\nChosen: " << describe(*chosen) << "\n";
+
+    const std::string& baseFile = std::filesystem::exists(outputFile)
+                                      ? outputFile
+                                      : clips.front().calibFile;
+    YAML::Node root;
+    try
+    {
+        root = YAML::LoadFile(baseFile);
+    }
+    catch(const YAML::Exception& ex)
+    {
+        std::cerr << "Error loading YAML file '" << baseFile
+                  << "': " << ex.what() << "\n";
+        return false;
+    }
+
+    if(chosen->candidate.processingScale > 0)
+    {
+        root["processing_scale"] = chosen->candidate.processingScale;
+    }
+
+    {
+        std::ofstream fout(outputFile);
+        if(!fout)
+        {
+            std::cerr << "Error writing to: " << outputFile << ".\n";
+            return false;
+        }
+        fout << root;
+    }
+
+    PipelineBuilder builder;
+    PipelineDirector director;
+    director.loadPipelineConfig(builder, clips.front().calibFile);
+    applyCandidate(chosen->candidate, builder);
+    director.savePipelineConfig(builder, outputFile);
+
+    return true;
+}
+
+/**
+ * @brief Reads the values of one swept parameter.
+ * @param sweepNode The sweep map of the spec, may be undefined.
+ * @param key The parameter key, with a scalar or sequence value.
+ * @param keepValue The value meaning "keep the clip value", the only
+ * value if the key is missing.
+ * @return The values to sweep, never empty.
+ */
+template<typename T>
+std::vector<T> PipelineAutotuner::readSweep(const YAML::Node& sweepNode,
+                                            const std::string& key,
+                                            T keepValue)
+{
+    if(!sweepNode || !sweepNode[key])
+        return {keepValue};
+
+    const YAML::Node& valuesNode = sweepNode[key];
+    if(valuesNode.IsScalar())
+        return {valuesNode.as<T>()};
+
+    std::vector<T> values;
+    for(const auto& valueNode : valuesNode)
+    {
+        values.push_back(valueNode.as<T>());
+    }
+
+    return values.empty() ? std::vector<T>{keepValue} : values;
+}
+
+/**
+ * @brief Builds the cartesian product of the swept values.
+ * @return The candidates of the sweep.
+ */
+std::vector<TuningCandidate> PipelineAutotuner::buildCandidates() const
+{
+    std::vector<TuningCandidate> candidates;
+
+    for(int kernelSize : gaussianKernelSizes)
+        for(int history : mog2Histories)
+            for(int dilation : dilationIterations)
+                for(int erosion : erosionIterations)
+                    for(double scale : processingScales)
+                    {
+                        TuningCandidate candidate;
+                        candidate.gaussianKernelSize = kernelSize;
+                        candidate.mog2History = history;
+                        candidate.dilationIterations = dilation;
+                        candidate.erosionIterations = erosion;
+                        candidate.processingScale = scale;
+                        candidates.push_back(candidate);
+                    }
+
+    return candidates;
+}
+
+/**
+ * @brief Runs the headless vehicle watcher with the candidate on every
+ * clip, in green phase, and compares the vehicle count to the ground
+ * truth. Runs on a worker thread, only touches its own files.
+ * The candidate is skipped if the watcher cannot run on a clip.
+ * @param candidate The parameters to evaluate.
+ * @param candidateIndex Index of the candidate, for unique file names.
+ * @return The counting error and frame time of the candidate.
+ */
+TuningResult PipelineAutotuner::evaluate(const TuningCandidate& candidate,
+                                         size_t candidateIndex) const
+{
+    TuningResult result;
+    result.candidate = candidate;
+
+    double totalError = 0;
+    double totalMs = 0;
+    int totalFrames = 0;
+
+    for(size_t i = 0; i < clips.size(); ++i)
+    {
+        const TuningClip& clip = clips[i];
+        std::string calibName = tempDir + "/autotune_" +
+                                std::to_string(candidateIndex) + "_" +
+                                std::to_string(i) + ".yaml";
+
+        // the frame count of the container can be an estimate, the loop
+        // below also stops at the end of the clip
+        int frames = getClipFrames(clip);
+
+        // checked here, the watcher only logs a calibration it cannot read
+        // and would then exit the process on the first frame
+        VideoStreamer calibCheck;
+        if(frames <= 0 || !writeCandidateCalib(candidate, clip, calibName) ||
+           !calibCheck.readCalibrationData(calibName))
+        {
+            std::cerr << "Error: Skipping candidate " << candidateIndex
+                      << ", the watcher cannot run on " << clip.videoFile
+                      << ".\n";
+            std::remove(calibName.c_str());
+            result.isSkipped = true;
+            return result;
+        }
+
+        WatcherSpawner spawner;
+        std::unique_ptr<Watcher> vehicleWatcher(
+            spawner.spawnWatcher(WatcherType::VEHICLE,
+                                 RenderMode::HEADLESS,
+                                 clip.videoFile,
+                                 calibName));
+        vehicleWatcher->setCurrentTrafficState(TrafficState::GREEN_PHASE);
+
+        int processedFrames = 0;
+        int64 start = cv::getTickCount();
+        while(processedFrames < frames && !vehicleWatcher->isStreamEnded())
+        {
+            vehicleWatcher->processFrame();
+            ++processedFrames;
+        }
+        int64 end = cv::getTickCount();
+
+        int count = vehicleWatcher->getInstanceCount();
+        std::remove(calibName.c_str());
+
+        totalError += std::abs(count - clip.groundTruthCount) /
+                      static_cast<double>(std::max(clip.groundTruthCount, 1));
+        totalMs += (end - start) * 1000.0 / cv::getTickFrequency();
+        totalFrames += processedFrames;
+    }
+
+    result.countError = totalError / clips.size();
+    result.msPerFrame = (totalFrames > 0) ? totalMs / totalFrames : 0;
+
+    return result;
+}
+
+/**
+ * @brief Gets the number of frames to process from a clip, its frame
+ * budget clamped to its length.
+ * @param clip The clip to open.
+ * @return The number of frames, 0 if the clip cannot be opened.
+ */
+int PipelineAutotuner::getClipFrames(const TuningClip& clip)
+{
+    cv::VideoCapture capture(clip.videoFile);
+    if(!capture.isOpened())
+        return 0;
+
+    int frameCount = static_cast<int>(capture.get(cv::CAP_PROP_FRAME_COUNT));
+    if(frameCount <= 0)
+        return clip.frames; // not reported by the backend
+
+    return std::min(clip.frames, frameCount);
+}
+
+/**
+ * @brief Writes the calibration of a clip with the candidate applied.
+ * The clip is replayed without pacing and without the pipelined stages,
+ * so the frame time is the processing time of each frame, and the watcher
+ * does not exit the process at the end of the clip.
+ * @param candidate The parameters to apply.
+ * @param clip The clip whose calibration is the base.
+ * @param calibName The calibration file to write.
+ * @return true if the file was written.
+ */
+bool PipelineAutotuner::writeCandidateCalib(const TuningCandidate& candidate,
+                                            const TuningClip& clip,
+                                            const std::string& calibName) const
+{
+    YAML::Node root;
+    try
+    {
+        root = YAML::LoadFile(clip.calibFile);
+    }
+    catch(const YAML::Exception& ex)
+    {
+        std::cerr << "Error loading YAML file '" << clip.calibFile
+                  << "': " << ex.what() << "\n";
+        return false;
+    }
+
+    if(candidate.processingScale > 0)
+    {
+        root["processing_scale"] = candidate.processingScale;
+    }
+    root["pacing"] = "max_throughput";
+    root["pipelined_processing"] = false;
+    root["exit_at_stream_end"] = false;
+
+    {
+        std::ofstream fout(calibName);
+        if(!fout)
+        {
+            std::cerr << "Error writing to: " << calibName << ".\n";
+            return false;
+        }
+        fout << root;
+    }
+
+    PipelineBuilder builder;
+    PipelineDirector director;
+    director.loadPipelineConfig(builder, clip.calibFile);
+    applyCandidate(candidate, builder);
+    director.savePipelineConfig(builder, calibName);
+
+    return true;
+}
+
+/**
+ * @brief Overrides the swept parameters of the matching steps.
+ * @param candidate The parameters to apply, negative ones are kept.
+ * @param builder The pipeline loaded from a clip calibration.
+ */
+void PipelineAutotuner::applyCandidate(const TuningCandidate& candidate,
+                                       PipelineBuilder& builder)
+{
+    for(size_t i = 0; i < builder.getNumberOfSteps(); ++i)
+    {
+        StepParameters params = builder.getStepCurrentParameters(i);
+
+        if(auto p = std::get_if<GaussianBlurParams>(&params.params))
+        {
+            if(candidate.gaussianKernelSize > 0)
+                p->kernelSize = candidate.gaussianKernelSize;
+        }
+        else if(auto p = std::get_if<MOG2BackgroundSubtractionParams>(
+                    &params.params))
+        {
+            if(candidate.mog2History > 0)
+                p->history = candidate.mog2History;
+        }
+        else if(auto p = std::get_if<DilationParams>(&params.params))
+        {
+            if(candidate.dilationIterations >= 0)
+                p->iterations = candidate.dilationIterations;
+        }
+        else if(auto p = std::get_if<ErosionParams>(&params.params))
+        {
+            if(candidate.erosionIterations >= 0)
+                p->iterations = candidate.erosionIterations;
+        }
+
+        builder.setStepParameters(i, params);
+    }
+}
+
+/**
+ * @brief Marks the candidates no other candidate beats on both the
+ * counting error and the frame time.
+ */
+void PipelineAutotuner::markParetoFront()
+{
+    for(auto& result : results)
+    {
+        if(result.isSkipped)
+        {
+            result.isParetoOptimal = false;
+            continue;
+        }
+
+        result.isParetoOptimal = std::none_of(
+            results.begin(), results.end(), [&](const TuningResult& other) {
+                if(other.isSkipped)
+                    return false;
+
+                bool noWorse = other.countError <= result.countError &&
+                               other.msPerFrame <= result.msPerFrame;
+                bool better = other.countError < result.countError ||
+                              other.msPerFrame < result.msPerFrame;
+                return noWorse && better;
+            });
+    }
+}
+
+/**
+ * @brief Picks the most accurate Pareto optimal candidate within the
+ * frame time budget, the fastest one on a tie. Without a budget, or if
+ * no candidate fits it, the most accurate one overall.
+ * @return The chosen candidate, nullptr if nothing was evaluated.
+ */
+const TuningResult* PipelineAutotuner::chooseResult() const
+{
+    auto isBetter = [](const TuningResult& a, const TuningResult* b) {
+        if(b == nullptr || a.countError != b->countError)
+            return b == nullptr || a.countError < b->countError;
+        return a.msPerFrame < b->msPerFrame;
+    };
+
+    const TuningResult* chosen = nullptr;
+    for(const auto& result : results)
+    {
+        bool fitsBudget = maxFrameMs <= 0 || result.msPerFrame <= maxFrameMs;
+        if(result.isParetoOptimal && fitsBudget && isBetter(result, chosen))
+            chosen = &result;
+    }
+
+    if(chosen == nullptr)
+    {
+        for(const auto& result : results)
+        {
+            if(result.isParetoOptimal && isBetter(result, chosen))
+                chosen = &result;
+        }
+    }
+
+    return chosen;
+}
+
+/**
+ * @brief Formats a result on one line, kept parameters shown as "-".
+ * @param result The result to describe.
+ * @return e.g. "error=8.3% frame=4.120ms blur=5 history=150 ...".
+ */
+std::string PipelineAutotuner::describe(const TuningResult& result)
+{
+    auto value = [](int parameter) {
+        return (parameter < 0) ? std::string("-") : std::to_string(parameter);
+    };
+
+    const TuningCandidate& candidate = result.candidate;
+    std::ostringstream description;
+    if(result.isSkipped)
+    {
+        description << "skipped";
+    }
+    else
+    {
+        description << std::fixed << std::setprecision(1)
+                    << "error=" << result.countError * 100.0 << "% frame="
+                    << std::setprecision(3) << result.msPerFrame << "ms";
+    }
+
+    description << std::fixed
+                << " blur=" << value(candidate.gaussianKernelSize)
+                << " history=" << value(candidate.mog2History)
+                << " dilation=" << value(candidate.dilationIterations)
+                << " erosion=" << value(candidate.erosionIterations)
+                << " scale=" << std::setprecision(2);
+
+    if(candidate.processingScale > 0)
+        description << candidate.processingScale;
+    else
+        description << "-";
+
+    return description.str();
+}
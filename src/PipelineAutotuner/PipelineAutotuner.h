@@ -0,0 +1,103 @@
+#ifndef PIPELINE_AUTOTUNER_H
+#define PIPELINE_AUTOTUNER_H
+
+#include "PipelineBuilder.h"
+#include <string>
+#include <vector>
+#include <yaml-cpp/yaml.h>
+
+/**
+ * @brief Recorded clip with its ground truth, counted by the headless
+ * vehicle watcher in green phase over the first frames of the clip.
+ */
+struct TuningClip
+{
+    std::string videoFile;
+    std::string calibFile;
+    int frames = 300;
+    int groundTruthCount = 0;
+};
+
+/**
+ * @brief One point of the sweep. A negative (or zero scale) value keeps
+ * the value of the clip calibration.
+ */
+struct TuningCandidate
+{
+    int gaussianKernelSize = -1;
+    int mog2History = -1;
+    int dilationIterations = -1;
+    int erosionIterations = -1;
+    double processingScale = 0;
+};
+
+/**
+ * @brief Counting error (mean relative error over the clips) and frame
+ * time (mean milliseconds per processed frame) of a candidate.
+ * A candidate the watcher could not run on every clip is skipped.
+ */
+struct TuningResult
+{
+    TuningCandidate candidate;
+    double countError = 0;
+    double msPerFrame = 0;
+    bool isSkipped = false;
+    bool isParetoOptimal = false;
+};
+
+/**
+ * @brief Offline sweep of the vehicle preprocessing parameters, trading
+ * counting accuracy against frame time. Every candidate runs the headless
+ * vehicle watcher on every clip, the candidates in parallel across the
+ * cores (OpenCV itself single threaded, so they do not compete for cores
+ * and the frame times stay comparable). The Pareto front of error against
+ * frame time is printed, and the chosen point, the most accurate within
+ * the optional frame time budget, is saved to the output calibration.
+ */
+class PipelineAutotuner
+{
+public:
+    explicit PipelineAutotuner(int jobs);
+
+    bool loadSpec(const std::string& yamlFilename);
+    void run();
+    void printParetoFront() const;
+    bool saveChosenConfig();
+
+private:
+    int jobs;
+
+    std::vector<TuningClip> clips;
+    std::vector<int> gaussianKernelSizes;
+    std::vector<int> mog2Histories;
+    std::vector<int> dilationIterations;
+    std::vector<int> erosionIterations;
+    std::vector<double> processingScales;
+    double maxFrameMs;
+    std::string outputFile;
+
+    // the calibrations written for the candidates, removed after the run
+    std::string tempDir;
+
+    std::vector<TuningResult> results;
+
+    template<typename T>
+    static std::vector<T> readSweep(const YAML::Node& sweepNode,
+                                    const std::string& key,
+                                    T keepValue);
+
+    std::vector<TuningCandidate> buildCandidates() const;
+    TuningResult evaluate(const TuningCandidate& candidate,
+                          size_t candidateIndex) const;
+    bool writeCandidateCalib(const TuningCandidate& candidate,
+                             const TuningClip& clip,
+                             const std::string& calibName) const;
+    static int getClipFrames(const TuningClip& clip);
+    static void applyCandidate(const TuningCandidate& candidate,
+                               PipelineBuilder& builder);
+    void markParetoFront();
+    const TuningResult* chooseResult() const;
+    static std::string describe(const TuningResult& result);
+};
+
+#endif
@@ -0,0 +1,51 @@
+#include "PipelineAutotuner.h"
+#include "cxxopts.hpp"
+#include <iostream>
+
+/**
+ * @brief Entry point of the offline pipeline autotuner.
+ *
+ * Sweeps the preprocessing parameters of the spec on its recorded clips,
+ * prints the Pareto front of counting error against frame time, and saves
+ * the chosen point to the output calibration.
+ */
+int main(int argc, char* argv[])
+{
+    cxxopts::Options options("PipelineAutotuner", "----------");
+
+    options.add_options()(
+        "s,spec",
+        "Tuning spec",
+        cxxopts::value<std::string>()->default_value("autotune.yaml"))(
+        "j,jobs",
+        "Parallel jobs (0 for one per CPU core)",
+        cxxopts::value<int>()->default_value("0"))(
+        "n,dry-run",
+        "Only print the Pareto front, save nothing",
+        cxxopts::value<bool>()->default_value("false"))(
+        "h,help", "Print usage");
+
+    auto result = options.parse(argc, argv);
+
+    if(result.count("help"))
+    {
+        std::cout << options.help();
+        exit(0);
+    }
+
+    PipelineAutotuner autotuner(result["jobs"].as<int>());
+    if(!autotuner.loadSpec(result["spec"].as<std::string>()))
+    {
+        return EXIT_FAILURE;
+    }
+
+    autotuner.run();
+    autotuner.printParetoFront();
+
+    if(!result["dry-run"].as<bool>() && !autotuner.saveChosenConfig())
+    {
+        return EXIT_FAILURE;
+    }
+
+    return 0;
+}
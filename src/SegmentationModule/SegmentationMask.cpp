@@ -33,15 +33,15 @@ cv::Mat SegmentationMask::generateMask(const cv::Mat& img, bool isBinaryMask)
         std::cerr << "Failed to initialize model.\n";
     }
 
-    cv::Mat converted_img;
-    cv::cvtColor(img, converted_img, cv::COLOR_BGR2RGB);
+    // member buffer, reused between frames
+    cv::cvtColor(img, rgbFrame, cv::COLOR_BGR2RGB);
 
     float conf_threshold = 0.30f;
     float iou_threshold = 0.45f;
     float mask_threshold = 0.5f;
     int conversion_code = cv::COLOR_BGR2RGB;
 
-    auto results = model->predict_once(converted_img,
+    auto results = model->predict_once(rgbFrame,
                                        conf_threshold,
                                        iou_threshold,
                                        mask_threshold,
@@ -68,17 +68,20 @@ cv::Mat
 SegmentationMask::processResults(const cv::Mat& img,
                                  const std::vector<YoloResults>& results)
 {
-    cv::Mat mask = cv::Mat::zeros(img.size(), img.type());
+    // the returned mask shares the member buffer, overwritten next frame
+    maskFrame.create(img.size(), img.type());
+    maskFrame.setTo(cv::Scalar::all(0));
 
     for(const auto& result : results)
     {
         if(result.mask.rows > 0 && result.mask.cols > 0)
         {
-            mask(result.bbox).setTo(cv::Scalar(255, 255, 255), result.mask);
+            maskFrame(result.bbox)
+                .setTo(cv::Scalar(255, 255, 255), result.mask);
         }
     }
 
-    return mask;
+    return maskFrame;
 }
 
 cv::Mat SegmentationMask::processResultsDebug(const cv::Mat& img,
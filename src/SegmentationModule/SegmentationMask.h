@@ -33,6 +33,9 @@ private:
     std::unique_ptr<AutoBackendOnnx> model;
     std::unique_ptr<ISegmentationStrategy> segmentationStrategy;
 
+    cv::Mat rgbFrame;
+    cv::Mat maskFrame;
+
     int detectionResultCount;
     std::unordered_map<std::string, int> countsByClassType;
 
@@ -0,0 +1,670 @@
+#include "TrafficBenchmark.h"
+#include "FramePool.h"
+#include "FusedPipeline.h"
+#include "HullTracker.h"
+#include "PipelineBuilder.h"
+#include "PipelineDirector.h"
+#include "StepFactory.h"
+#include "WarpPerspective.h"
+#include "WatcherSpawner.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <unistd.h>
+#include <yaml-cpp/yaml.h>
+
+/**
+ * @brief Runs all the benchmark cases at 720p and 1080p.
+ */
+void TrafficBenchmark::run()
+{
+    std::cout << "\nStarting benchmark (" << BENCH_ITERATIONS
+              << " iterations per case)...\n";
+
+    const std::vector<cv::Size> frameSizes = {cv::Size(1280, 720),
+                                              cv::Size(1920, 1080)};
+
+    for(const auto& frameSize : frameSizes)
+    {
+        std::cout << "\n[" << frameSize.width << "x" << frameSize.height
+                  << "]\n";
+        benchmarkWarpPerspective(frameSize);
+        benchmarkFramePool(frameSize);
+        benchmarkFusedPipeline(frameSize);
+        benchmarkParallelPipeline(frameSize);
+        benchmarkStaticPipeline(frameSize);
+        benchmarkBackgroundSubtraction(frameSize);
+        benchmarkMorphology(frameSize);
+    }
+
+    benchmarkDownscaledCounting();
+    benchmarkTrackerScaling();
+}
+
+/**
+ * @brief Per-frame cv::warpPerspective against the precomputed
+ * remap tables of WarpPerspective, using an ROI similar to the sample
+ * vehicle calibration (scaled to the frame size).
+ * @param frameSize size of the synthetic BGR input frame.
+ */
+void TrafficBenchmark::benchmarkWarpPerspective(const cv::Size& frameSize)
+{
+    cv::Mat frame(frameSize, CV_8UC3);
+    cv::randu(frame, cv::Scalar::all(0), cv::Scalar::all(255));
+
+    WarpPerspective warpPerspective;
+    cv::Mat roiMatrix;
+    std::vector<cv::Point2f> roiPoints = getRoiPoints(frameSize);
+    warpPerspective.initialize(frame, roiPoints, roiMatrix);
+
+    cv::Mat remapped;
+    warpPerspective.apply(frame, remapped, roiMatrix); // builds the tables
+    cv::Size outputSize = remapped.size();
+
+    cv::Mat warped;
+    double baselineMs = measureMsPerFrame(
+        [&] { cv::warpPerspective(frame, warped, roiMatrix, outputSize); });
+    double optimizedMs = measureMsPerFrame(
+        [&] { warpPerspective.apply(frame, remapped, roiMatrix); });
+
+    printResult("WarpPerspective (warp -> remap)", baselineMs, optimizedMs);
+
+    double maxDiff = cv::norm(warped, remapped, cv::NORM_INF);
+    std::cout << "  max abs pixel difference: " << maxDiff << "\n";
+}
+
+/**
+ * @brief Tracking frame path of the vehicle watchers (warp then the
+ * default preprocessing pipeline), copying the warped frame before
+ * preprocessing in place, against writing into the pooled buffers.
+ * Also prints the cv::Mat allocations per frame of both paths.
+ * @param frameSize size of the synthetic BGR input frame.
+ */
+void TrafficBenchmark::benchmarkFramePool(const cv::Size& frameSize)
+{
+    FramePool::installAllocationCounter();
+    FramePool framePool;
+    cv::Mat& frame = framePool.getFrame(FrameSlot::INPUT);
+    frame.create(frameSize, CV_8UC3);
+    cv::randu(frame, cv::Scalar::all(0), cv::Scalar::all(255));
+
+    WarpPerspective warpPerspective;
+    cv::Mat roiMatrix;
+    std::vector<cv::Point2f> roiPoints = getRoiPoints(frameSize);
+    warpPerspective.initialize(frame, roiPoints, roiMatrix);
+
+    PipelineDirector pipeDirector;
+    PipelineBuilder copyBuilder;
+    PipelineBuilder pooledBuilder;
+    pipeDirector.setupDefaultPipeline(copyBuilder);
+    pipeDirector.setupDefaultPipeline(pooledBuilder);
+
+    cv::Mat warpedFrame;
+    cv::Mat processFrame;
+    auto copyPath = [&] {
+        warpPerspective.apply(frame, warpedFrame, roiMatrix);
+        warpedFrame.copyTo(processFrame);
+        copyBuilder.process(processFrame);
+    };
+
+    cv::Mat& pooledWarped = framePool.getFrame(FrameSlot::ROI);
+    cv::Mat& pooledProcess = framePool.getFrame(FrameSlot::PROCESS);
+    auto pooledPath = [&] {
+        warpPerspective.apply(frame, pooledWarped, roiMatrix);
+        pooledBuilder.process(pooledWarped, pooledProcess);
+    };
+
+    double baselineMs = measureMsPerFrame(copyPath);
+    double optimizedMs = measureMsPerFrame(pooledPath);
+
+    printResult("Preprocess (copy -> frame pool)", baselineMs, optimizedMs);
+
+    std::cout << "  cv::Mat allocations per frame: "
+              << countAllocationsPerFrame(copyPath) << " -> "
+              << countAllocationsPerFrame(pooledPath) << "\n";
+}
+
+/**
+ * @brief Default preprocessing pipeline run step by step over the full
+ * frame (PipelineBuilder), against the plan compiled from it where the
+ * neighbouring steps are fused and run band by band (FusedPipeline).
+ * @param frameSize size of the synthetic BGR input frames.
+ */
+void TrafficBenchmark::benchmarkFusedPipeline(const cv::Size& frameSize)
+{
+    PipelineDirector pipeDirector;
+    PipelineBuilder stepBuilder;
+    pipeDirector.setupDefaultPipeline(stepBuilder);
+
+    // compiled steps are new instances, with their own MOG2 model
+    FusedPipeline fusedPipeline;
+    fusedPipeline.compile(stepBuilder);
+
+    comparePipelines(
+        "Preprocess (step by step -> fused bands)",
+        frameSize,
+        [&](const cv::Mat& frame, cv::Mat& output) {
+            stepBuilder.process(frame, output);
+        },
+        [&](const cv::Mat& frame, cv::Mat& output) {
+            fusedPipeline.process(frame, output);
+        });
+
+    std::cout << "  plan: " << fusedPipeline.getPlanDescription() << "\n";
+}
+
+/**
+ * @brief Fused plan of the default pipeline run on one core, against
+ * the same plan with its bands and MOG2 model split across the cores.
+ * @param frameSize size of the synthetic BGR input frames.
+ */
+void TrafficBenchmark::benchmarkParallelPipeline(const cv::Size& frameSize)
+{
+    PipelineDirector pipeDirector;
+    PipelineBuilder stepBuilder;
+    pipeDirector.setupDefaultPipeline(stepBuilder);
+
+    FusedPipeline serialPipeline;
+    FusedPipeline parallelPipeline;
+    serialPipeline.compile(stepBuilder);
+    parallelPipeline.compile(stepBuilder);
+    parallelPipeline.setParallel(true);
+
+    comparePipelines(
+        "Preprocess (serial -> parallel bands)",
+        frameSize,
+        [&](const cv::Mat& frame, cv::Mat& output) {
+            serialPipeline.process(frame, output);
+        },
+        [&](const cv::Mat& frame, cv::Mat& output) {
+            parallelPipeline.process(frame, output);
+        });
+
+    std::cout << "  threads: " << cv::getNumThreads() << "\n";
+}
+
+/**
+ * @brief Default pipeline run by the builder, step by step through the
+ * IPreprocessStep interface, against its compile time specialization.
+ * @param frameSize size of the synthetic BGR input frames.
+ */
+void TrafficBenchmark::benchmarkStaticPipeline(const cv::Size& frameSize)
+{
+    PipelineDirector pipeDirector;
+    PipelineBuilder stepBuilder;
+    pipeDirector.setupDefaultPipeline(stepBuilder);
+
+    std::unique_ptr<IStaticPipeline> staticPipeline =
+        PipelineDirector::createStaticPipeline(stepBuilder);
+    if(!staticPipeline)
+    {
+        std::cerr << "Error: No static pipeline matches the default "
+                     "pipeline.\n";
+        return;
+    }
+
+    comparePipelines(
+        "Preprocess (builder -> static)",
+        frameSize,
+        [&](const cv::Mat& frame, cv::Mat& output) {
+            stepBuilder.process(frame, output);
+        },
+        [&](const cv::Mat& frame, cv::Mat& output) {
+            staticPipeline->process(frame, output);
+        });
+
+    std::cout << "  steps: " << staticPipeline->getDescription() << "\n";
+}
+
+/**
+ * @brief Runs two preprocessing pipelines, each starting from a fresh
+ * background model, on the same moving sequence, prints the largest
+ * difference of their outputs (0 if they are equivalent), then times
+ * them on the sequence.
+ * @param label name of the case, see printResult.
+ * @param frameSize size of the synthetic BGR input frames.
+ * @param baseline the reference pipeline.
+ * @param candidate the pipeline compared to the reference.
+ */
+void TrafficBenchmark::comparePipelines(const std::string& label,
+                                        const cv::Size& frameSize,
+                                        const ProcessFrame& baseline,
+                                        const ProcessFrame& candidate) const
+{
+    const int frameCount = 30;
+    std::vector<cv::Mat> frames = getMovingFrames(frameSize, frameCount);
+
+    cv::Mat baselineOutput;
+    cv::Mat candidateOutput;
+    double maxDiff = 0;
+    for(const auto& frame : frames)
+    {
+        baseline(frame, baselineOutput);
+        candidate(frame, candidateOutput);
+        maxDiff = std::max(
+            maxDiff, cv::norm(baselineOutput, candidateOutput, cv::NORM_INF));
+    }
+
+    int baselineIndex = 0;
+    int candidateIndex = 0;
+    double baselineMs = measureMsPerFrame([&] {
+        baseline(frames[baselineIndex++ % frameCount], baselineOutput);
+    });
+    double optimizedMs = measureMsPerFrame([&] {
+        candidate(frames[candidateIndex++ % frameCount], candidateOutput);
+    });
+
+    printResult(label, baselineMs, optimizedMs);
+
+    std::cout << "  max abs pixel difference: " << maxDiff << "\n";
+}
+
+/**
+ * @brief MOG2 background subtraction against the approximate median
+ * step, with the default parameters of both, on a moving grayscale
+ * sequence. Also prints how many pixels of the last foreground masks
+ * agree, after the threshold (at 200) that follows in the pipeline.
+ * @param frameSize size of the synthetic frames.
+ */
+void TrafficBenchmark::benchmarkBackgroundSubtraction(
+    const cv::Size& frameSize)
+{
+    const int frameCount = 30;
+    std::vector<cv::Mat> frames = getMovingFrames(frameSize, frameCount);
+    for(auto& frame : frames)
+    {
+        cv::cvtColor(frame, frame, cv::COLOR_BGR2GRAY);
+    }
+
+    auto mog2Step = StepFactory::createStep(
+        StepType::MOG2BackgroundSubtraction,
+        StepParameters{MOG2BackgroundSubtractionParams{}});
+    auto medianStep = StepFactory::createStep(
+        StepType::ApproxMedianBackgroundSubtraction,
+        StepParameters{ApproxMedianBackgroundSubtractionParams{}});
+
+    cv::Mat mog2Mask;
+    cv::Mat medianMask;
+    int mog2Index = 0;
+    int medianIndex = 0;
+    double baselineMs = measureMsPerFrame([&] {
+        mog2Step->process(frames[mog2Index++ % frameCount], mog2Mask);
+    });
+    double optimizedMs = measureMsPerFrame([&] {
+        medianStep->process(frames[medianIndex++ % frameCount], medianMask);
+    });
+
+    printResult("Background (MOG2 -> approx median)", baselineMs, optimizedMs);
+
+    cv::Mat mog2Foreground = mog2Mask > 200;
+    cv::Mat medianForeground = medianMask > 200;
+    double agreement =
+        1.0 - cv::countNonZero(mog2Foreground != medianForeground) /
+                  static_cast<double>(mog2Mask.total());
+    std::cout << "  foreground mask agreement: " << std::setprecision(1)
+              << agreement * 100.0 << "%\n";
+}
+
+/**
+ * @brief Default dilation then erosion steps with their iterations run
+ * by cv::dilate/cv::erode, against the optimized mode collapsing them
+ * into constant cost per pixel passes, on a foreground-like binary mask.
+ * Also prints how many mask pixels differ, as the iterated ellipses are
+ * approximated by a few rectangles and the frame borders are not exact.
+ * Run with one and with several OpenCV threads.
+ * @param frameSize size of the synthetic mask.
+ */
+void TrafficBenchmark::benchmarkMorphology(const cv::Size& frameSize)
+{
+    cv::Mat noise(frameSize, CV_8UC1);
+    cv::randu(noise, cv::Scalar::all(0), cv::Scalar::all(255));
+    cv::Mat mask = noise > 250;
+    for(const auto& frame : getMovingFrames(frameSize, 1))
+    {
+        cv::Mat blocks;
+        cv::cvtColor(frame, blocks, cv::COLOR_BGR2GRAY);
+        mask.setTo(cv::Scalar::all(255), blocks > 200);
+    }
+
+    DilationParams dilationParams;
+    ErosionParams erosionParams;
+    auto dilation = StepFactory::createStep(StepType::Dilation,
+                                            StepParameters{dilationParams});
+    auto erosion = StepFactory::createStep(StepType::Erosion,
+                                           StepParameters{erosionParams});
+
+    dilationParams.optimized = true;
+    erosionParams.optimized = true;
+    auto fastDilation = StepFactory::createStep(
+        StepType::Dilation, StepParameters{dilationParams});
+    auto fastErosion = StepFactory::createStep(StepType::Erosion,
+                                               StepParameters{erosionParams});
+
+    // single threaded and with the OpenCV workers, as the optimized
+    // passes run their rows and columns in parallel
+    int defaultThreads = cv::getNumThreads();
+    for(int threads : {1, std::max(defaultThreads, 2)})
+    {
+        cv::setNumThreads(threads);
+
+        cv::Mat dilated;
+        cv::Mat output;
+        cv::Mat fastOutput;
+        double baselineMs = measureMsPerFrame([&] {
+            dilation->process(mask, dilated);
+            erosion->process(dilated, output);
+        });
+        double optimizedMs = measureMsPerFrame([&] {
+            fastDilation->process(mask, dilated);
+            fastErosion->process(dilated, fastOutput);
+        });
+
+        printResult("Morphology (iterated -> optimized), " +
+                        std::to_string(threads) + " threads",
+                    baselineMs,
+                    optimizedMs);
+
+        double mismatch = cv::countNonZero(output != fastOutput) /
+                          static_cast<double>(output.total());
+        std::cout << "  differing mask pixels: " << std::setprecision(2)
+                  << mismatch * 100.0 << "%\n";
+    }
+
+    cv::setNumThreads(defaultThreads);
+}
+
+/**
+ * @brief Vehicle counting of the headless watcher on the test video
+ * (green phase, as the test mode), with the MOG2 model of its pipeline
+ * at full resolution against 2x and 4x downscaled. Prints the cost of
+ * the whole frame processing, and the counts, the full resolution one
+ * being the reference. Needs testVehicle.mp4 and testVehicle.yaml in the
+ * working directory, like the test mode.
+ */
+void TrafficBenchmark::benchmarkDownscaledCounting()
+{
+    const std::string streamName = "testVehicle.mp4";
+    const std::string calibName = "testVehicle.yaml";
+    const int frameCount = 100;
+
+    YAML::Node calibration;
+    try
+    {
+        calibration = YAML::LoadFile(calibName);
+    }
+    catch(const YAML::Exception& ex)
+    {
+        std::cerr << "Error: Skipping the counting benchmark, cannot load '"
+                  << calibName << "': " << ex.what() << "\n";
+        return;
+    }
+
+    if(!std::ifstream(streamName).good())
+    {
+        std::cerr << "Error: Skipping the counting benchmark, cannot open '"
+                  << streamName << "'.\n";
+        return;
+    }
+
+    std::cout << "\n[" << streamName << ", " << frameCount << " frames]\n";
+
+    double referenceMs = 0;
+    int referenceCount = 0;
+    for(int downscale : {1, 2, 4})
+    {
+        // same calibration, only the MOG2 model resolution differs
+        for(auto stepNode : calibration["pipeline_config"])
+        {
+            if(stepNode["type"].as<std::string>() ==
+               "MOG2BackgroundSubtraction")
+            {
+                stepNode["parameters"]["downscale"] = downscale;
+            }
+        }
+
+        // written aside, not to clutter the working directory
+        std::string benchCalibName =
+            (std::filesystem::temp_directory_path() /
+             ("benchDownscale" + std::to_string(downscale) + "_" +
+              std::to_string(getpid()) + ".yaml"))
+                .string();
+        if(!(std::ofstream(benchCalibName) << calibration))
+        {
+            std::cerr << "Error: Skipping the counting benchmark, cannot "
+                      << "write '" << benchCalibName << "'.\n";
+            return;
+        }
+
+        WatcherSpawner spawner;
+        Watcher* vehicleWatcher = spawner.spawnWatcher(WatcherType::VEHICLE,
+                                                       RenderMode::HEADLESS,
+                                                       streamName,
+                                                       benchCalibName);
+        vehicleWatcher->setCurrentTrafficState(TrafficState::GREEN_PHASE);
+
+        int64 start = cv::getTickCount();
+        for(int currFrame = 0; currFrame < frameCount; ++currFrame)
+        {
+            vehicleWatcher->processFrame();
+        }
+        int64 end = cv::getTickCount();
+
+        double msPerFrame =
+            (end - start) * 1000.0 / cv::getTickFrequency() / frameCount;
+        int count = vehicleWatcher->getInstanceCount();
+
+        delete vehicleWatcher;
+        std::remove(benchCalibName.c_str());
+
+        if(downscale == 1)
+        {
+            referenceMs = msPerFrame;
+            referenceCount = count;
+            continue;
+        }
+
+        printResult("Counting (MOG2 full -> " + std::to_string(downscale) +
+                        "x downscaled)",
+                    referenceMs,
+                    msPerFrame);
+        std::cout << "  vehicle count: " << count
+                  << " (full resolution: " << referenceCount << ")\n";
+    }
+}
+
+/**
+ * @brief ROI similar to the sample vehicle calibration,
+ * scaled to the frame size.
+ * @param frameSize size of the synthetic input frame.
+ * @return the four ROI points.
+ */
+std::vector<cv::Point2f>
+TrafficBenchmark::getRoiPoints(const cv::Size& frameSize) const
+{
+    return {cv::Point2f(0.40f * frameSize.width, 0.60f * frameSize.height),
+            cv::Point2f(0.62f * frameSize.width, 0.53f * frameSize.height),
+            cv::Point2f(0.43f * frameSize.width, 0.32f * frameSize.height),
+            cv::Point2f(0.35f * frameSize.width, 0.32f * frameSize.height)};
+}
+
+/**
+ * @brief Synthetic sequence of a few bright blocks moving over a static
+ * noisy background, so the background subtraction has foreground.
+ * @param frameSize size of the BGR frames.
+ * @param frameCount number of frames of the sequence.
+ * @return the frames of the sequence.
+ */
+std::vector<cv::Mat>
+TrafficBenchmark::getMovingFrames(const cv::Size& frameSize,
+                                  int frameCount) const
+{
+    cv::Mat background(frameSize, CV_8UC3);
+    cv::randu(background, cv::Scalar::all(0), cv::Scalar::all(120));
+
+    cv::Size blockSize(frameSize.width / 10, frameSize.height / 8);
+    std::vector<cv::Mat> frames(frameCount);
+
+    for(int i = 0; i < frameCount; ++i)
+    {
+        background.copyTo(frames[i]);
+
+        for(int lane = 0; lane < 3; ++lane)
+        {
+            int x = (lane + 1) * frameSize.width / 4 - blockSize.width / 2;
+            int y = (i * 20 + lane * frameSize.height / 3) %
+                    (frameSize.height - blockSize.height);
+            cv::rectangle(frames[i],
+                          cv::Rect(cv::Point(x, y), blockSize),
+                          cv::Scalar(230, 230, 230),
+                          cv::FILLED);
+        }
+    }
+
+    return frames;
+}
+
+/**
+ * @brief HullTracker matching with every trackable scanning all the new
+ * blobs, against the BlobGrid lookup, from 10 to 500 blobs per frame.
+ * The blobs sit on a jittered lattice filling a 1080p lane, as close as
+ * in congested traffic at 500, and move back and forth so every trackable
+ * stays matched. Also prints the trackables kept by both, which should
+ * not differ. Both matchings are measured, the global one only up to 200
+ * blobs since its assignment step is cubic whatever the lookup.
+ */
+void TrafficBenchmark::benchmarkTrackerScaling()
+{
+    const cv::Size laneSize(1920, 1080);
+    const std::vector<int> blobCounts = {10, 20, 50, 100, 200, 500};
+    const float jitter = 8.0f;
+    const int maxGlobalBlobs = 200;
+
+    std::cout << "\n[Tracker]\n";
+
+    cv::RNG rng(42);
+    for(int blobCount : blobCounts)
+    {
+        double spacing =
+            std::sqrt(laneSize.area() / static_cast<double>(blobCount));
+        int columns = std::max(static_cast<int>(laneSize.width / spacing), 1);
+
+        std::vector<HullBlob> blobs(blobCount);
+        for(int i = 0; i < blobCount; ++i)
+        {
+            blobs[i].area = rng.uniform(2000.0f, 6000.0f);
+            blobs[i].centroid =
+                cv::Point2f((i % columns + 0.5) * spacing + rng.uniform(-5, 5),
+                            (i / columns + 0.5) * spacing + rng.uniform(-5, 5));
+        }
+
+        std::vector<HullBlob> movedBlobs = blobs;
+        for(auto& blob : movedBlobs)
+        {
+            blob.centroid.y += jitter;
+        }
+
+        for(TrackMatching matching :
+            {TrackMatching::FIRST_FIT, TrackMatching::GLOBAL})
+        {
+            bool isGlobal = matching == TrackMatching::GLOBAL;
+            if(isGlobal && blobCount > maxGlobalBlobs)
+                continue;
+
+            // exit line far below, so no trackable is counted and removed
+            HullTracker scanTracker;
+            HullTracker gridTracker;
+            scanTracker.initExitBoundaryLine(laneSize.height * 10);
+            gridTracker.initExitBoundaryLine(laneSize.height * 10);
+            scanTracker.setMatching(matching);
+            gridTracker.setMatching(matching);
+            scanTracker.setGridLookup(false);
+            gridTracker.setGridLookup(true);
+
+            int scanFrame = 0;
+            int gridFrame = 0;
+            double baselineMs = measureMsPerFrame([&] {
+                scanTracker.update((scanFrame++ % 2) ? movedBlobs : blobs);
+            });
+            double optimizedMs = measureMsPerFrame([&] {
+                gridTracker.update((gridFrame++ % 2) ? movedBlobs : blobs);
+            });
+
+            printResult("Tracking " + std::to_string(blobCount) +
+                            " blobs, " + (isGlobal ? "global" : "first fit") +
+                            " (scan -> grid)",
+                        baselineMs,
+                        optimizedMs);
+
+            std::cout << "  tracked: " << scanTracker.getTrackedHulls().size()
+                      << " -> " << gridTracker.getTrackedHulls().size()
+                      << "\n";
+        }
+    }
+}
+
+/**
+ * @brief Counts the cv::Mat buffer allocations of a unit of per-frame work
+ * in steady state, i.e. after a few warm up runs.
+ * Needs FramePool::installAllocationCounter to have been called.
+ * @param work the per-frame work to measure.
+ * @return average allocations per call.
+ */
+double TrafficBenchmark::countAllocationsPerFrame(
+    const std::function<void()>& work) const
+{
+    for(int i = 0; i < WARMUP_ITERATIONS; ++i)
+    {
+        work();
+    }
+
+    uint64_t start = FramePool::getAllocationCount();
+    for(int i = 0; i < BENCH_ITERATIONS; ++i)
+    {
+        work();
+    }
+    uint64_t end = FramePool::getAllocationCount();
+
+    return static_cast<double>(end - start) / BENCH_ITERATIONS;
+}
+
+/**
+ * @brief Times a unit of per-frame work after a few warm up runs.
+ * @param work the per-frame work to measure.
+ * @return average milliseconds per call.
+ */
+double TrafficBenchmark::measureMsPerFrame(
+    const std::function<void()>& work) const
+{
+    for(int i = 0; i < WARMUP_ITERATIONS; ++i)
+    {
+        work();
+    }
+
+    int64 start = cv::getTickCount();
+    for(int i = 0; i < BENCH_ITERATIONS; ++i)
+    {
+        work();
+    }
+    int64 end = cv::getTickCount();
+
+    return (end - start) * 1000.0 / cv::getTickFrequency() / BENCH_ITERATIONS;
+}
+
+/**
+ * @brief Prints the per-frame cost of both implementations and the speedup.
+ * @param label name of the benchmark case.
+ * @param baselineMs milliseconds per frame of the previous implementation.
+ * @param optimizedMs milliseconds per frame of the current implementation.
+ */
+void TrafficBenchmark::printResult(const std::string& label,
+                                   double baselineMs,
+                                   double optimizedMs) const
+{
+    std::cout << "  " << label << ": " << std::fixed << std::setprecision(3)
+              << baselineMs << " ms -> " << optimizedMs << " ms ("
+              << std::setprecision(2) << baselineMs / optimizedMs << "x)\n";
+}
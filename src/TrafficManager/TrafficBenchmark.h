@@ -0,0 +1,49 @@
+#ifndef TRAFFIC_BENCHMARK_H
+#define TRAFFIC_BENCHMARK_H
+
+#include <functional>
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Micro benchmarks of the per-frame hot paths (benchmark mode).
+ * Each case compares the previous implementation (baseline) with the
+ * current one on synthetic frames, and prints the milliseconds per frame.
+ */
+class TrafficBenchmark
+{
+public:
+    void run();
+
+private:
+    static constexpr int WARMUP_ITERATIONS = 10;
+    static constexpr int BENCH_ITERATIONS = 200;
+
+    using ProcessFrame = std::function<void(const cv::Mat&, cv::Mat&)>;
+
+    void benchmarkWarpPerspective(const cv::Size& frameSize);
+    void benchmarkFramePool(const cv::Size& frameSize);
+    void benchmarkFusedPipeline(const cv::Size& frameSize);
+    void benchmarkParallelPipeline(const cv::Size& frameSize);
+    void benchmarkStaticPipeline(const cv::Size& frameSize);
+    void benchmarkBackgroundSubtraction(const cv::Size& frameSize);
+    void benchmarkMorphology(const cv::Size& frameSize);
+    void benchmarkDownscaledCounting();
+    void benchmarkTrackerScaling();
+
+    void comparePipelines(const std::string& label,
+                          const cv::Size& frameSize,
+                          const ProcessFrame& baseline,
+                          const ProcessFrame& candidate) const;
+    std::vector<cv::Point2f> getRoiPoints(const cv::Size& frameSize) const;
+    std::vector<cv::Mat> getMovingFrames(const cv::Size& frameSize,
+                                         int frameCount) const;
+    double measureMsPerFrame(const std::function<void()>& work) const;
+    double countAllocationsPerFrame(const std::function<void()>& work) const;
+    void printResult(const std::string& label,
+                     double baselineMs,
+                     double optimizedMs) const;
+};
+
+#endif
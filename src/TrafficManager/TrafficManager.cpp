@@ -1,17 +1,20 @@
 #include "TrafficManager.h"
 #include "MultiprocessTraffic.h"
+#include "TrafficBenchmark.h"
 #include "WatcherSpawner.h"
 
 TrafficManager::TrafficManager(const std::string& configFile,
                                bool debug,
                                bool calib,
                                bool verbose,
-                               bool test)
+                               bool test,
+                               bool bench)
     : configFile(configFile)
     , debugMode(debug)
     , calibMode(calib)
     , verbose(verbose)
     , testMode(test)
+    , benchMode(bench)
 {}
 
 void TrafficManager::start()
@@ -23,6 +26,14 @@ void TrafficManager::start()
         exit(EXIT_SUCCESS);
     }
 
+    if(benchMode)
+    {
+        TrafficBenchmark benchmark;
+        benchmark.run();
+        std::cout << "\nBenchmark Finished!!\n";
+        exit(EXIT_SUCCESS);
+    }
+
     std::cout << "TrafficManager starting...\n";
 
     std::cout << "Debug Mode: " << (debugMode ? "true" : "false") << "\n";
@@ -10,7 +10,8 @@ public:
                    bool debug,
                    bool calib,
                    bool verbose,
-                   bool test);
+                   bool test,
+                   bool bench);
 
     void start();
 
@@ -20,6 +21,7 @@ private:
     bool calibMode;
     bool verbose;
     bool testMode;
+    bool benchMode;
 
     void test();
     void initTestVariables();
@@ -0,0 +1,87 @@
+#include "FramePacer.h"
+#include <thread>
+
+FramePacer::FramePacer()
+    : mode(PacingMode::LIVE)
+    , frameIntervalMs(1000.0 / 30.0)
+    , isAnchored(false)
+    , anchorTimestampMs(0)
+    , pacedFrames(0)
+{}
+
+/**
+ * @brief Sets the pacing policy and restarts the deadlines.
+ * @param mode see PacingMode, usually from VideoStreamer::getPacingMode.
+ * @param framesPerSec used when the stream has no timestamps.
+ */
+void FramePacer::initialize(PacingMode mode, double framesPerSec)
+{
+    this->mode = mode;
+    frameIntervalMs = (framesPerSec > 0) ? 1000.0 / framesPerSec : 0;
+
+    reset();
+}
+
+/**
+ * @brief Restarts the deadlines from the next frame,
+ * e.g. after the processing was paused during another traffic phase.
+ */
+void FramePacer::reset()
+{
+    isAnchored = false;
+    pacedFrames = 0;
+}
+
+/**
+ * @brief Waits until the deadline of the frame that was just read.
+ * The first frame after a reset sets the anchor, then each frame is due
+ * at anchor + (its timestamp - anchor timestamp). If the frame is already
+ * more than one frame interval late, the anchor is moved to now instead
+ * of rushing the next frames to catch up.
+ * @param streamTimestampMs position of the frame in the stream
+ * (cv::CAP_PROP_POS_MSEC), negative to assume a constant frame rate.
+ */
+void FramePacer::waitFrameDeadline(double streamTimestampMs)
+{
+    if(mode != PacingMode::FILE_REALTIME)
+        return;
+
+    Clock::time_point now = Clock::now();
+
+    double frameTimeMs = (streamTimestampMs >= 0)
+                             ? streamTimestampMs
+                             : pacedFrames * frameIntervalMs;
+    ++pacedFrames;
+
+    if(!isAnchored)
+    {
+        isAnchored = true;
+        anchorTime = now;
+        anchorTimestampMs = frameTimeMs;
+        return;
+    }
+
+    std::chrono::duration<double, std::milli> offset(frameTimeMs -
+                                                     anchorTimestampMs);
+    Clock::time_point deadline =
+        anchorTime + std::chrono::duration_cast<Clock::duration>(offset);
+
+    std::chrono::duration<double, std::milli> lateness = now - deadline;
+    if(lateness.count() > frameIntervalMs)
+    {
+        anchorTime = now;
+        anchorTimestampMs = frameTimeMs;
+        return;
+    }
+
+    std::this_thread::sleep_until(deadline);
+}
+
+/**
+ * @brief Getter for the pacing policy.
+ * @return the current PacingMode.
+ */
+PacingMode FramePacer::getMode() const
+{
+    return mode;
+}
@@ -0,0 +1,44 @@
+#ifndef FRAME_PACER_H
+#define FRAME_PACER_H
+
+#include <chrono>
+
+enum class PacingMode
+{
+    LIVE,
+    FILE_REALTIME,
+    FILE_MAX_THROUGHPUT
+};
+
+/**
+ * @brief Deadline based frame pacing, aware of the source type.
+ * Live sources are never delayed since reading already waits for the
+ * next frame to arrive. File sources are either paced to the stream
+ * timestamps (real time replay) or not throttled at all.
+ * Unlike a fixed sleep per frame, the processing time is absorbed
+ * by the deadline, and a late frame never makes the next one wait.
+ */
+class FramePacer
+{
+public:
+    FramePacer();
+
+    void initialize(PacingMode mode, double framesPerSec);
+    void reset();
+    void waitFrameDeadline(double streamTimestampMs = -1);
+
+    PacingMode getMode() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    PacingMode mode;
+    double frameIntervalMs;
+
+    bool isAnchored;
+    Clock::time_point anchorTime;
+    double anchorTimestampMs;
+    double pacedFrames;
+};
+
+#endif
@@ -0,0 +1,195 @@
+#include "FramePool.h"
+#include <atomic>
+#include <mutex>
+
+namespace
+{
+std::atomic<uint64_t> matAllocationCount{0};
+std::atomic<bool> allocationCounterInstalled{false};
+
+/**
+ * @brief Forwards to the previous default allocator,
+ * counting each new cv::Mat buffer (not the user data wrappers).
+ */
+class CountingMatAllocator : public cv::MatAllocator
+{
+public:
+    explicit CountingMatAllocator(cv::MatAllocator* baseAllocator)
+        : baseAllocator(baseAllocator)
+    {}
+
+    cv::UMatData* allocate(int dims,
+                           const int* sizes,
+                           int type,
+                           void* data,
+                           size_t* step,
+                           cv::AccessFlag flags,
+                           cv::UMatUsageFlags usageFlags) const override
+    {
+        if(data == nullptr)
+        {
+            matAllocationCount.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        return baseAllocator->allocate(
+            dims, sizes, type, data, step, flags, usageFlags);
+    }
+
+    bool allocate(cv::UMatData* data,
+                  cv::AccessFlag accessFlags,
+                  cv::UMatUsageFlags usageFlags) const override
+    {
+        return baseAllocator->allocate(data, accessFlags, usageFlags);
+    }
+
+    void deallocate(cv::UMatData* data) const override
+    {
+        baseAllocator->deallocate(data);
+    }
+
+private:
+    cv::MatAllocator* baseAllocator;
+};
+
+} // namespace
+
+FramePool::FramePool()
+    : frameStartCount(0)
+    , frameAllocations(0)
+    , allocatingFrames(0)
+    , countedFrames(0)
+{}
+
+/**
+ * @brief Allocates the buffer of a slot ahead of the first frame.
+ * Stages writing the same size and type into it will reuse the buffer.
+ * @param slot the frame slot to size.
+ * @param size expected frame size of the stage writing into the slot.
+ * @param type expected cv::Mat type, e.g. CV_8UC1 for masks.
+ */
+void FramePool::reserve(FrameSlot slot, const cv::Size& size, int type)
+{
+    getFrame(slot).create(size, type);
+}
+
+/**
+ * @brief Gets the buffer of a slot, pass it as the output of a stage.
+ * @param slot the frame slot.
+ * @return reference to the pooled frame, valid for the pool lifetime.
+ */
+cv::Mat& FramePool::getFrame(FrameSlot slot)
+{
+    return frames[static_cast<size_t>(slot)];
+}
+
+/**
+ * @brief Marks the start of the per-frame work to count allocations of.
+ */
+void FramePool::beginFrame()
+{
+    frameStartCount = getAllocationCount();
+}
+
+/**
+ * @brief Marks the end of the per-frame work started with beginFrame.
+ */
+void FramePool::endFrame()
+{
+    frameAllocations = getAllocationCount() - frameStartCount;
+    ++countedFrames;
+
+    if(frameAllocations > 0)
+    {
+        ++allocatingFrames;
+    }
+}
+
+/**
+ * @brief Gets the cv::Mat allocations of the last counted frame.
+ * @return zero in steady state.
+ */
+uint64_t FramePool::getFrameAllocations() const
+{
+    return frameAllocations;
+}
+
+/**
+ * @brief Gets how many counted frames allocated at least once, expected
+ * to stop growing after the first frames of each traffic phase.
+ * @return the number of frames with allocations.
+ */
+uint64_t FramePool::getAllocatingFrames() const
+{
+    return allocatingFrames;
+}
+
+/**
+ * @brief Gets how many frames were counted, see beginFrame/endFrame.
+ * @return the number of counted frames.
+ */
+uint64_t FramePool::getCountedFrames() const
+{
+    return countedFrames;
+}
+
+/**
+ * @brief Formats the allocation counts for the periodic watcher stats.
+ * @return e.g. "cv::Mat allocations: last frame 0, 3 of 900 frames
+ * allocating", or a note that the counter is not installed.
+ */
+std::string FramePool::getAllocationReport() const
+{
+    if(!isCountingAllocations())
+        return "cv::Mat allocations: not counted\n";
+
+    return "cv::Mat allocations: last frame " +
+           std::to_string(frameAllocations) + ", " +
+           std::to_string(allocatingFrames) + " of " +
+           std::to_string(countedFrames) + " frames allocating\n";
+}
+
+/**
+ * @brief Restarts the frame counts, e.g. at the end of a sample.
+ */
+void FramePool::resetAllocationStats()
+{
+    frameAllocations = 0;
+    allocatingFrames = 0;
+    countedFrames = 0;
+}
+
+/**
+ * @brief Wraps the default cv::Mat allocator of the process with the
+ * allocation counter. Opt-in, since every cv::Mat then goes through it,
+ * for the benchmarks and the watchers with allocation stats enabled.
+ * Only the first call installs it.
+ */
+void FramePool::installAllocationCounter()
+{
+    static std::once_flag installFlag;
+    std::call_once(installFlag, [] {
+        // never deleted, cv::Mat may still allocate during static destruction
+        cv::Mat::setDefaultAllocator(
+            new CountingMatAllocator(cv::Mat::getDefaultAllocator()));
+        allocationCounterInstalled = true;
+    });
+}
+
+/**
+ * @brief Checks if installAllocationCounter was called.
+ * @return true if the cv::Mat allocations are counted.
+ */
+bool FramePool::isCountingAllocations()
+{
+    return allocationCounterInstalled;
+}
+
+/**
+ * @brief Gets the total cv::Mat allocations of the process
+ * since the counter was installed.
+ * @return the allocation count, 0 if not installed.
+ */
+uint64_t FramePool::getAllocationCount()
+{
+    return matAllocationCount.load(std::memory_order_relaxed);
+}
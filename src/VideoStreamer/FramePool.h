@@ -0,0 +1,55 @@
+#ifndef FRAME_POOL_H
+#define FRAME_POOL_H
+
+#include <array>
+#include <cstdint>
+#include <opencv2/opencv.hpp>
+#include <string>
+
+enum class FrameSlot
+{
+    INPUT,
+    ROI,
+    PROCESS,
+    ROI_MASK,
+    DISPLAY,
+    COUNT
+};
+
+/**
+ * @brief Per-watcher set of frame buffers that every stage writes into,
+ * sized once at initialize so the steady state never allocates a frame.
+ * Once installAllocationCounter wrapped the default cv::Mat allocator of
+ * the process (opt-in, it affects every cv::Mat), beginFrame/endFrame give
+ * the number of cv::Mat buffers allocated during one frame (all threads).
+ */
+class FramePool
+{
+public:
+    FramePool();
+
+    void reserve(FrameSlot slot, const cv::Size& size, int type);
+    cv::Mat& getFrame(FrameSlot slot);
+
+    void beginFrame();
+    void endFrame();
+    uint64_t getFrameAllocations() const;
+    uint64_t getAllocatingFrames() const;
+    uint64_t getCountedFrames() const;
+    std::string getAllocationReport() const;
+    void resetAllocationStats();
+
+    static void installAllocationCounter();
+    static bool isCountingAllocations();
+    static uint64_t getAllocationCount();
+
+private:
+    std::array<cv::Mat, static_cast<size_t>(FrameSlot::COUNT)> frames;
+
+    uint64_t frameStartCount;
+    uint64_t frameAllocations;
+    uint64_t allocatingFrames;
+    uint64_t countedFrames;
+};
+
+#endif
@@ -0,0 +1,118 @@
+#include "FrameRingBuffer.h"
+#include <algorithm>
+#include <chrono>
+
+FrameRingBuffer::FrameRingBuffer(size_t capacity)
+{
+    reset(capacity);
+}
+
+/**
+ * @brief Clears the ring and resizes it. Only call this while
+ * no capture thread is writing to the ring.
+ * @param capacity number of frame slots, minimum of two
+ * (one for writing and one for reading).
+ */
+void FrameRingBuffer::reset(size_t capacity)
+{
+    std::lock_guard<std::mutex> lock(ringMutex);
+
+    slots.assign(std::max<size_t>(capacity, 2), Slot{cv::Mat(), 0.0});
+    head = 0;
+    count = 0;
+    writeIndex = 0;
+    droppedCount = 0;
+    isClosed = false;
+}
+
+/**
+ * @brief Gets the slot the producer should decode the next frame into.
+ * If the ring is already full, the oldest unread frame is dropped.
+ * The slot buffer is reused, so no allocation happens in steady state.
+ * @return reference to the frame to write, valid until commitWriteSlot.
+ */
+cv::Mat& FrameRingBuffer::acquireWriteSlot()
+{
+    std::lock_guard<std::mutex> lock(ringMutex);
+
+    // always keep one slot free for writing
+    if(count == slots.size() - 1)
+    {
+        head = (head + 1) % slots.size();
+        --count;
+        ++droppedCount;
+    }
+
+    writeIndex = (head + count) % slots.size();
+    return slots[writeIndex].frame;
+}
+
+/**
+ * @brief Publishes the frame written in the slot from acquireWriteSlot.
+ * @param timestampMs the time (steady clock, ms) the frame was decoded.
+ */
+void FrameRingBuffer::commitWriteSlot(double timestampMs)
+{
+    {
+        std::lock_guard<std::mutex> lock(ringMutex);
+        slots[writeIndex].timestampMs = timestampMs;
+        ++count;
+    }
+    frameAvailable.notify_one();
+}
+
+/**
+ * @brief Takes the newest frame in the ring, discarding the older ones.
+ * The frame buffers are swapped, not copied, so the passed frame
+ * should not be shared with anything else.
+ * @param frame receives the newest frame.
+ * @param timestampMs receives the time the newest frame was decoded.
+ * @param timeoutMs how long to wait when there is no new frame yet.
+ * @return true if a new frame was taken, false on timeout or if closed.
+ */
+bool FrameRingBuffer::popLatest(cv::Mat& frame,
+                                double& timestampMs,
+                                int timeoutMs)
+{
+    std::unique_lock<std::mutex> lock(ringMutex);
+
+    auto timeout = std::chrono::milliseconds(timeoutMs);
+    frameAvailable.wait_for(
+        lock, timeout, [this] { return count > 0 || isClosed; });
+
+    if(count == 0)
+        return false;
+
+    size_t newest = (head + count - 1) % slots.size();
+    cv::swap(frame, slots[newest].frame);
+    timestampMs = slots[newest].timestampMs;
+
+    // the older frames were never read by the consumer
+    droppedCount += count - 1;
+    head = (head + count) % slots.size();
+    count = 0;
+
+    return true;
+}
+
+/**
+ * @brief Wakes up a waiting consumer, e.g. when stopping the capture.
+ */
+void FrameRingBuffer::close()
+{
+    {
+        std::lock_guard<std::mutex> lock(ringMutex);
+        isClosed = true;
+    }
+    frameAvailable.notify_all();
+}
+
+/**
+ * @brief Gets the number of decoded frames that were never consumed.
+ * @return total dropped frames since the last reset.
+ */
+uint64_t FrameRingBuffer::getDroppedCount() const
+{
+    std::lock_guard<std::mutex> lock(ringMutex);
+    return droppedCount;
+}
@@ -0,0 +1,51 @@
+#ifndef FRAME_RING_BUFFER_H
+#define FRAME_RING_BUFFER_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+/**
+ * @brief Small bounded ring of decoded frames shared between one
+ * capture (producer) thread and one consumer thread.
+ * When the ring is full, the oldest frame is overwritten (drop-oldest),
+ * so the consumer always gets the newest frame available.
+ * @param capacity number of frame slots, including the one being written.
+ */
+class FrameRingBuffer
+{
+public:
+    explicit FrameRingBuffer(size_t capacity = 4);
+
+    void reset(size_t capacity);
+
+    cv::Mat& acquireWriteSlot();
+    void commitWriteSlot(double timestampMs);
+
+    bool popLatest(cv::Mat& frame, double& timestampMs, int timeoutMs);
+    void close();
+
+    uint64_t getDroppedCount() const;
+
+private:
+    struct Slot
+    {
+        cv::Mat frame;
+        double timestampMs;
+    };
+
+    std::vector<Slot> slots;
+    size_t head;
+    size_t count;
+    size_t writeIndex;
+
+    uint64_t droppedCount;
+    bool isClosed;
+
+    mutable std::mutex ringMutex;
+    std::condition_variable frameAvailable;
+};
+
+#endif
@@ -0,0 +1,160 @@
+#include "MotionGate.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+MotionGate::MotionGate()
+    : stillFrameInterval(1)
+    , frozenFrameLimit(0)
+    , stillFrames(0)
+    , motionHoldFrames(0)
+    , identicalFrames(0)
+    , skippedFrames(0)
+    , feedFrozen(false)
+{
+    initialize(1, DEFAULT_FPS);
+}
+
+/**
+ * @brief Sets the gating policy and restarts the comparison.
+ * @param stillFrameInterval one still frame in this many is processed,
+ * 1 processes every frame (only the frozen feed check remains).
+ * @param framesPerSec stream frame rate, for the frozen feed duration.
+ */
+void MotionGate::initialize(int stillFrameInterval, double framesPerSec)
+{
+    this->stillFrameInterval = std::max(stillFrameInterval, 1);
+
+    double fps = (framesPerSec > 0) ? framesPerSec : DEFAULT_FPS;
+    frozenFrameLimit = static_cast<int>(std::ceil(FROZEN_FEED_SECONDS * fps));
+
+    reset();
+}
+
+/**
+ * @brief Forgets the previous frame, so the next one is processed,
+ * e.g. when the tracking restarts after another traffic phase.
+ */
+void MotionGate::reset()
+{
+    previousBlockMeans.release();
+    stillFrames = 0;
+    motionHoldFrames = 0;
+    identicalFrames = 0;
+    skippedFrames = 0;
+    feedFrozen = false;
+}
+
+/**
+ * @brief Compares the frame with the previous one, and decides if it
+ * goes through the preprocessing, detection and tracking.
+ * Motion keeps the gate open for MOTION_HOLD_FRAMES more frames, so a
+ * vehicle slowing down is still tracked up to the exit line.
+ * @param frame the ROI frame, grayscale or BGR, same size every call.
+ * @return true if the frame should be processed, false to skip it.
+ */
+bool MotionGate::update(const cv::Mat& frame)
+{
+    computeBlockMeans(frame);
+
+    if(previousBlockMeans.size() != blockMeans.size())
+    {
+        cv::swap(blockMeans, previousBlockMeans);
+        updateFrozenState(false);
+        return true;
+    }
+
+    cv::absdiff(blockMeans, previousBlockMeans, blockDiff);
+    cv::swap(blockMeans, previousBlockMeans);
+
+    double maxDiff = 0;
+    cv::minMaxLoc(blockDiff, nullptr, &maxDiff);
+    updateFrozenState(maxDiff == 0);
+
+    int changedBlocks = (maxDiff > BLOCK_DIFF_THRESHOLD)
+                            ? cv::countNonZero(blockDiff > BLOCK_DIFF_THRESHOLD)
+                            : 0;
+
+    if(changedBlocks >= MIN_CHANGED_BLOCKS)
+    {
+        motionHoldFrames = MOTION_HOLD_FRAMES;
+        stillFrames = 0;
+        return true;
+    }
+
+    if(motionHoldFrames > 0)
+    {
+        --motionHoldFrames;
+        return true;
+    }
+
+    // a frozen feed has nothing new for the background model either
+    if(!feedFrozen && ++stillFrames >= stillFrameInterval)
+    {
+        stillFrames = 0;
+        return true;
+    }
+
+    ++skippedFrames;
+    return false;
+}
+
+/**
+ * @brief Getter for the frozen feed state.
+ * @return true if the frames did not change for FROZEN_FEED_SECONDS.
+ */
+bool MotionGate::isFeedFrozen() const
+{
+    return feedFrozen;
+}
+
+/**
+ * @brief Getter for the number of frames skipped since the last reset.
+ * @return the skipped frame count.
+ */
+uint64_t MotionGate::getSkippedFrames() const
+{
+    return skippedFrames;
+}
+
+/**
+ * @brief Reduces the frame to the mean gray level of each block, reading
+ * every pixel once, the color conversion only runs on the block means.
+ * @param frame the ROI frame, grayscale or BGR.
+ */
+void MotionGate::computeBlockMeans(const cv::Mat& frame)
+{
+    cv::Size blocks(std::max(frame.cols / BLOCK_SIZE, 1),
+                    std::max(frame.rows / BLOCK_SIZE, 1));
+    cv::resize(frame, blockMeans, blocks, 0, 0, cv::INTER_AREA);
+
+    if(blockMeans.channels() != 1)
+    {
+        cv::cvtColor(blockMeans, blockMeans, cv::COLOR_BGR2GRAY);
+    }
+}
+
+/**
+ * @brief Counts the consecutive identical frames, and reports when the
+ * feed freezes or recovers.
+ * @param isIdentical true if the block means did not change at all.
+ */
+void MotionGate::updateFrozenState(bool isIdentical)
+{
+    identicalFrames = isIdentical ? identicalFrames + 1 : 0;
+
+    bool isFrozen = identicalFrames >= frozenFrameLimit;
+    if(isFrozen == feedFrozen)
+        return;
+
+    feedFrozen = isFrozen;
+    if(isFrozen)
+    {
+        std::cerr << "Warning: Video feed frozen, no change in the last "
+                  << identicalFrames << " frames.\n";
+    }
+    else
+    {
+        std::cout << "Video feed recovered.\n";
+    }
+}
@@ -0,0 +1,56 @@
+#ifndef MOTION_GATE_H
+#define MOTION_GATE_H
+
+#include <atomic>
+#include <cstdint>
+#include <opencv2/opencv.hpp>
+
+/**
+ * @brief Cheap per-frame motion check ahead of the preprocessing pipeline.
+ * The ROI frame is reduced to the mean of each block, and compared with
+ * the previous block means. Frames with (or shortly after) motion are
+ * processed, still frames are skipped except one in stillFrameInterval,
+ * which keeps the background model updated at a reduced rate.
+ * Block means that stay exactly identical for FROZEN_FEED_SECONDS mean
+ * the camera feed is frozen, since sensor noise alone changes them.
+ */
+class MotionGate
+{
+public:
+    MotionGate();
+
+    void initialize(int stillFrameInterval, double framesPerSec);
+    void reset();
+    bool update(const cv::Mat& frame);
+
+    bool isFeedFrozen() const;
+    uint64_t getSkippedFrames() const;
+
+private:
+    static constexpr int BLOCK_SIZE = 16;
+    static constexpr int BLOCK_DIFF_THRESHOLD = 6; // in gray levels
+    static constexpr int MIN_CHANGED_BLOCKS = 2;
+    static constexpr int MOTION_HOLD_FRAMES = 10;
+    static constexpr double FROZEN_FEED_SECONDS = 10.0;
+    static constexpr double DEFAULT_FPS = 30.0;
+
+    int stillFrameInterval;
+    int frozenFrameLimit;
+
+    cv::Mat blockMeans;
+    cv::Mat previousBlockMeans;
+    cv::Mat blockDiff;
+
+    int stillFrames;
+    int motionHoldFrames;
+    int identicalFrames;
+
+    // read by the watcher while a pipeline stage updates the gate
+    std::atomic<uint64_t> skippedFrames;
+    std::atomic<bool> feedFrozen;
+
+    void computeBlockMeans(const cv::Mat& frame);
+    void updateFrozenState(bool isIdentical);
+};
+
+#endif
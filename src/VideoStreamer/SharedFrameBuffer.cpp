@@ -0,0 +1,338 @@
+#include "SharedFrameBuffer.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "shared memory atomics must be lock free");
+
+SharedFrameBuffer::SharedFrameBuffer()
+    : isWriter(false)
+    , mappedSize(0)
+    , header(nullptr)
+    , frameData(nullptr)
+    , lastReadFrame(0)
+    , lastTimestampMs(-1)
+{}
+
+SharedFrameBuffer::~SharedFrameBuffer()
+{
+    close();
+}
+
+/**
+ * @brief Creates the shared memory segment of a stream (writer side).
+ * A stale segment with the same name is replaced.
+ * @param name shared memory name, without the leading slash.
+ * @param frameSize size of the frames that will be written.
+ * @param frameType cv::Mat type of the frames that will be written.
+ * @param framesPerSec stream FPS, forwarded to the readers.
+ * @return true if the segment is ready for writing.
+ */
+bool SharedFrameBuffer::create(const std::string& name,
+                               const cv::Size& frameSize,
+                               int frameType,
+                               double framesPerSec)
+{
+    close();
+    shmName = "/" + name;
+    shm_unlink(shmName.c_str());
+
+    int fd = shm_open(shmName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if(fd == -1)
+    {
+        std::cerr << "Error: Unable to create shared memory " << shmName
+                  << ": " << strerror(errno) << "\n";
+        return false;
+    }
+
+    size_t frameBytes = frameSize.area() * CV_ELEM_SIZE(frameType);
+    size_t size = getDataOffset() + SLOT_COUNT * frameBytes;
+
+    if(ftruncate(fd, size) == -1 || !mapSegment(fd, size))
+    {
+        std::cerr << "Error: Unable to map shared memory " << shmName
+                  << ": " << strerror(errno) << "\n";
+        ::close(fd);
+        shm_unlink(shmName.c_str());
+        return false;
+    }
+    ::close(fd);
+
+    isWriter = true;
+
+    // the segment is zero filled, only the fields need to be set
+    header->width = frameSize.width;
+    header->height = frameSize.height;
+    header->type = frameType;
+    header->frameBytes = frameBytes;
+    header->framesPerSec = framesPerSec;
+    header->latestFrame.store(0, std::memory_order_relaxed);
+    header->latestSlot.store(0, std::memory_order_relaxed);
+
+    // readers only map the segment once it is marked ready
+    header->magic.store(READY_MAGIC, std::memory_order_release);
+
+    return true;
+}
+
+/**
+ * @brief Opens the shared memory segment of a stream (reader side).
+ * Waits for the writer, since the decode service may still be
+ * connecting to the camera when the watchers start.
+ * @param name shared memory name, without the leading slash.
+ * @param timeoutMs how long to wait for the writer.
+ * @return true if the segment is ready for reading.
+ */
+bool SharedFrameBuffer::open(const std::string& name, int timeoutMs)
+{
+    close();
+    shmName = "/" + name;
+
+    auto deadline = std::chrono::steady_clock::now() +
+                    std::chrono::milliseconds(timeoutMs);
+
+    while(std::chrono::steady_clock::now() < deadline)
+    {
+        int fd = shm_open(shmName.c_str(), O_RDWR, 0600);
+
+        struct stat segmentStat;
+        if(fd != -1 && fstat(fd, &segmentStat) == 0 &&
+           static_cast<size_t>(segmentStat.st_size) > getDataOffset() &&
+           mapSegment(fd, segmentStat.st_size))
+        {
+            ::close(fd);
+
+            if(header->magic.load(std::memory_order_acquire) == READY_MAGIC)
+            {
+                lastReadFrame = 0;
+                return true;
+            }
+
+            close();
+        }
+        else if(fd != -1)
+        {
+            ::close(fd);
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+
+    std::cerr << "Error: Shared memory " << shmName
+              << " not ready, is the decode service running?\n";
+    return false;
+}
+
+/**
+ * @brief Unmaps the segment, the writer also removes its name.
+ */
+void SharedFrameBuffer::close()
+{
+    if(header == nullptr)
+        return;
+
+    munmap(header, mappedSize);
+
+    if(isWriter)
+    {
+        shm_unlink(shmName.c_str());
+    }
+
+    header = nullptr;
+    frameData = nullptr;
+    mappedSize = 0;
+    isWriter = false;
+}
+
+/**
+ * @brief Publishes a frame, into the slot not holding the latest frame.
+ * A frame not matching the size/type of the slots (e.g. the camera
+ * resolution changed) replaces the segment with one sized for it.
+ * @param frame the decoded frame.
+ * @param timestampMs stream position of the frame, in milliseconds.
+ */
+void SharedFrameBuffer::write(const cv::Mat& frame, double timestampMs)
+{
+    if(!isWriter || frame.empty())
+        return;
+
+    if(frame.cols != header->width || frame.rows != header->height ||
+       frame.type() != header->type)
+    {
+        std::cerr << "Warning: Frame size changed for " << shmName
+                  << ", reallocating the shared memory.\n";
+
+        // the readers keep their mapping of the old segment until they
+        // see it is stale, then open the new one under the same name
+        std::string name = shmName.substr(1);
+        double framesPerSec = header->framesPerSec;
+        header->magic.store(STALE_MAGIC, std::memory_order_release);
+
+        if(!create(name, frame.size(), frame.type(), framesPerSec))
+            return;
+    }
+
+    int slotIndex = 1 - header->latestSlot.load(std::memory_order_relaxed);
+    Slot& slot = header->slots[slotIndex];
+
+    // odd sequence while writing, readers retry or pick the other slot
+    uint64_t sequence = slot.sequence.load(std::memory_order_relaxed);
+    slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    uchar* slotData = frameData + slotIndex * header->frameBytes;
+    cv::Mat slotFrame(frame.size(), frame.type(), slotData);
+    frame.copyTo(slotFrame);
+
+    uint64_t frameIndex =
+        header->latestFrame.load(std::memory_order_relaxed) + 1;
+    slot.frameIndex = frameIndex;
+    slot.timestampMs = timestampMs;
+
+    slot.sequence.store(sequence + 2, std::memory_order_release);
+    header->latestSlot.store(slotIndex, std::memory_order_release);
+    header->latestFrame.store(frameIndex, std::memory_order_release);
+}
+
+/**
+ * @brief Copies the newest frame, waiting for one newer than the
+ * previous read, like a read from a live stream.
+ * @param frame output frame, its buffer is reused between reads.
+ * @param timeoutMs how long to wait for a new frame.
+ * @return false if no new frame was published in time.
+ */
+bool SharedFrameBuffer::read(cv::Mat& frame, int timeoutMs)
+{
+    if(header == nullptr || isWriter)
+        return false;
+
+    auto deadline = std::chrono::steady_clock::now() +
+                    std::chrono::milliseconds(timeoutMs);
+
+    while(std::chrono::steady_clock::now() < deadline)
+    {
+        if(header->magic.load(std::memory_order_acquire) == STALE_MAGIC)
+        {
+            // replaced by the writer after a frame size change
+            auto remainingMs =
+                std::chrono::duration_cast<std::chrono::milliseconds>(
+                    deadline - std::chrono::steady_clock::now());
+            if(!open(shmName.substr(1), std::max<int>(remainingMs.count(), 0)))
+                return false;
+
+            continue;
+        }
+
+        if(header->latestFrame.load(std::memory_order_acquire) <=
+           lastReadFrame)
+        {
+            std::this_thread::sleep_for(
+                std::chrono::microseconds(POLL_SLEEP_US));
+            continue;
+        }
+
+        int slotIndex = header->latestSlot.load(std::memory_order_acquire);
+        Slot& slot = header->slots[slotIndex];
+
+        uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+        if(sequence % 2 != 0)
+            continue; // being written, the latest slot changes next
+
+        uchar* slotData = frameData + slotIndex * header->frameBytes;
+        cv::Mat(header->height, header->width, header->type, slotData)
+            .copyTo(frame);
+        uint64_t frameIndex = slot.frameIndex;
+        double timestampMs = slot.timestampMs;
+
+        // the copy is only valid if the writer did not touch the slot
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if(slot.sequence.load(std::memory_order_relaxed) != sequence)
+            continue;
+
+        lastReadFrame = frameIndex;
+        lastTimestampMs = timestampMs;
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * @brief Getter for the mapping state.
+ * @return true if the segment is mapped.
+ */
+bool SharedFrameBuffer::isOpened() const
+{
+    return header != nullptr;
+}
+
+/**
+ * @brief Stream properties, a subset of cv::VideoCapture::get.
+ * @param propId cv::CAP_PROP_FRAME_WIDTH, FRAME_HEIGHT, FPS or POS_MSEC.
+ * @return the property value, or 0 if not available.
+ */
+double SharedFrameBuffer::get(int propId) const
+{
+    if(header == nullptr)
+        return 0;
+
+    switch(propId)
+    {
+    case cv::CAP_PROP_FRAME_WIDTH:
+        return header->width;
+    case cv::CAP_PROP_FRAME_HEIGHT:
+        return header->height;
+    case cv::CAP_PROP_FPS:
+        return header->framesPerSec;
+    case cv::CAP_PROP_POS_MSEC:
+        return lastTimestampMs;
+    default:
+        return 0;
+    }
+}
+
+/**
+ * @brief Removes a segment name left by a previous run.
+ * @param name shared memory name, without the leading slash.
+ */
+void SharedFrameBuffer::unlink(const std::string& name)
+{
+    shm_unlink(("/" + name).c_str());
+}
+
+/**
+ * @brief Maps an opened shared memory file descriptor.
+ * @param fd the descriptor from shm_open.
+ * @param size size of the segment.
+ * @return true if mapped.
+ */
+bool SharedFrameBuffer::mapSegment(int fd, size_t size)
+{
+    void* address =
+        mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if(address == MAP_FAILED)
+        return false;
+
+    mappedSize = size;
+    header = static_cast<Header*>(address);
+    frameData = static_cast<uchar*>(address) + getDataOffset();
+
+    return true;
+}
+
+/**
+ * @brief Offset of the first frame slot, cache line aligned.
+ * @return offset in bytes from the start of the segment.
+ */
+size_t SharedFrameBuffer::getDataOffset()
+{
+    constexpr size_t alignment = 64;
+    return (sizeof(Header) + alignment - 1) / alignment * alignment;
+}
@@ -0,0 +1,84 @@
+#ifndef SHARED_FRAME_BUFFER_H
+#define SHARED_FRAME_BUFFER_H
+
+#include <atomic>
+#include <cstdint>
+#include <opencv2/opencv.hpp>
+#include <string>
+
+/**
+ * @brief Latest decoded frame of one stream, shared between processes
+ * through POSIX shared memory (one writer, any number of readers).
+ * The writer alternates between two slots, each guarded by a sequence
+ * lock, so readers copy the newest frame without ever blocking the writer.
+ * When the frame size or type changes, the writer replaces the segment and
+ * marks the old one stale, the readers then map the new one.
+ * Stream links of the form "shm://<name>" are read from this buffer
+ * by VideoStreamer, see DecodeService for the writer side.
+ */
+class SharedFrameBuffer
+{
+public:
+    SharedFrameBuffer();
+    ~SharedFrameBuffer();
+
+    SharedFrameBuffer(const SharedFrameBuffer&) = delete;
+    SharedFrameBuffer& operator=(const SharedFrameBuffer&) = delete;
+
+    bool create(const std::string& name,
+                const cv::Size& frameSize,
+                int frameType,
+                double framesPerSec);
+    bool open(const std::string& name, int timeoutMs);
+    void close();
+
+    void write(const cv::Mat& frame, double timestampMs);
+    bool read(cv::Mat& frame, int timeoutMs);
+
+    bool isOpened() const;
+    double get(int propId) const;
+
+    static void unlink(const std::string& name);
+
+    static constexpr const char* LINK_PREFIX = "shm://";
+
+private:
+    static constexpr uint32_t READY_MAGIC = 0x53484652; // "SHFR"
+    static constexpr uint32_t STALE_MAGIC = 0x53484653; // "SHFS"
+    static constexpr int SLOT_COUNT = 2;
+    static constexpr int POLL_SLEEP_US = 500;
+
+    struct Slot
+    {
+        std::atomic<uint64_t> sequence;
+        uint64_t frameIndex;
+        double timestampMs;
+    };
+
+    struct Header
+    {
+        std::atomic<uint32_t> magic;
+        int32_t width;
+        int32_t height;
+        int32_t type;
+        uint64_t frameBytes;
+        double framesPerSec;
+        std::atomic<uint64_t> latestFrame;
+        std::atomic<int32_t> latestSlot;
+        Slot slots[SLOT_COUNT];
+    };
+
+    std::string shmName;
+    bool isWriter;
+    size_t mappedSize;
+    Header* header;
+    uchar* frameData;
+
+    uint64_t lastReadFrame;
+    double lastTimestampMs;
+
+    bool mapSegment(int fd, size_t size);
+    static size_t getDataOffset();
+};
+
+#endif
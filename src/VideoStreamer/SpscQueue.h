@@ -0,0 +1,112 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief Bounded lock-free queue between exactly one producer thread and
+ * one consumer thread. The items are slots written and read in place,
+ * so item buffers (e.g. cv::Mat) are reused instead of reallocated.
+ * The producer fills acquireWriteSlot() then calls commitWrite(),
+ * the consumer reads peekReadSlot() then calls commitRead(). Both return
+ * nullptr instead of blocking when the queue is full/empty.
+ * @param capacity number of items the queue can hold.
+ */
+template<typename T>
+class SpscQueue
+{
+public:
+    explicit SpscQueue(size_t capacity = 2)
+        : slots(capacity > 0 ? capacity : 1)
+        , readCount(0)
+        , writeCount(0)
+    {}
+
+    /**
+     * @brief Empties the queue and changes its capacity.
+     * Only while neither the producer nor the consumer use it.
+     * @param capacity number of items the queue can hold.
+     */
+    void reset(size_t capacity)
+    {
+        slots.resize(capacity > 0 ? capacity : 1);
+        readCount.store(0, std::memory_order_relaxed);
+        writeCount.store(0, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Producer side, gets the slot of the next item.
+     * @return the slot to fill, nullptr if the queue is full.
+     */
+    T* acquireWriteSlot()
+    {
+        size_t written = writeCount.load(std::memory_order_relaxed);
+        if(written - readCount.load(std::memory_order_acquire) ==
+           slots.size())
+            return nullptr;
+
+        return &slots[written % slots.size()];
+    }
+
+    /**
+     * @brief Producer side, publishes the slot from acquireWriteSlot.
+     */
+    void commitWrite()
+    {
+        writeCount.fetch_add(1, std::memory_order_release);
+    }
+
+    /**
+     * @brief Consumer side, gets the oldest item.
+     * @return the item, nullptr if the queue is empty.
+     */
+    T* peekReadSlot()
+    {
+        size_t read = readCount.load(std::memory_order_relaxed);
+        if(read == writeCount.load(std::memory_order_acquire))
+            return nullptr;
+
+        return &slots[read % slots.size()];
+    }
+
+    /**
+     * @brief Consumer side, gives the slot from peekReadSlot back.
+     */
+    void commitRead()
+    {
+        readCount.fetch_add(1, std::memory_order_release);
+    }
+
+    /**
+     * @brief Number of items in the queue, from any thread.
+     * @return the occupancy, only a snapshot while the threads run.
+     */
+    size_t size() const
+    {
+        // read first, it can only catch up with the write count
+        size_t read = readCount.load(std::memory_order_acquire);
+        return writeCount.load(std::memory_order_acquire) - read;
+    }
+
+    /**
+     * @brief Maximum number of items, see reset.
+     * @return the capacity.
+     */
+    size_t capacity() const
+    {
+        return slots.size();
+    }
+
+private:
+    static constexpr size_t CACHE_LINE = 64;
+
+    std::vector<T> slots;
+
+    // on separate cache lines, each is only written by one side
+    alignas(CACHE_LINE) std::atomic<size_t> readCount;
+    alignas(CACHE_LINE) std::atomic<size_t> writeCount;
+};
+
+#endif
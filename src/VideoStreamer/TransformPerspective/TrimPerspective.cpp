@@ -2,16 +2,16 @@
 #include <opencv2/opencv.hpp>
 
 TrimPerspective::TrimPerspective()
-    : isBoxInitialized(false)
+    : boundingBox(0, 0, 0, 0)
 {}
 
 /**
  * @brief Initialize Trim Perspective for a focused ROI.
- * This function takes the inside ROI pixels
- * and fills the rest with black pixels.
- * @param frame needed to get frame size and type.
+ * This function computes the ROI bounding box and a single-channel
+ * mask of the ROI polygon, with the same size as the bounding box.
+ * @param frame not used in this strategy.
  * @param roiPoints the four unsorted ROI points.
- * @param roiMatrix the matrix to fill non-black pixels.
+ * @param roiMatrix the mask to store the ROI polygon (CV_8UC1).
  */
 void TrimPerspective::initialize(cv::Mat& frame,
                                  std::vector<cv::Point2f>& roiPoints,
@@ -32,39 +32,39 @@ void TrimPerspective::initialize(cv::Mat& frame,
             cv::Point(static_cast<int>(point.x), static_cast<int>(point.y)));
     }
 
+    boundingBox = cv::boundingRect(intPoints);
+
+    // polygon relative to the bounding box
+    for(auto& point : intPoints)
+    {
+        point -= boundingBox.tl();
+    }
+
     // fill only the region of interest part
-    roiMatrix = cv::Mat::zeros(frame.size(), frame.type());
+    roiMatrix = cv::Mat::zeros(boundingBox.size(), CV_8UC1);
     cv::fillConvexPoly(roiMatrix,
                        intPoints.data(),
                        static_cast<int>(intPoints.size()),
-                       cv::Scalar(255, 255, 255));
-
-    isBoxInitialized = false;
+                       cv::Scalar(255));
 }
 
 /**
  * @brief Apply Trim Perspective for a focused ROI.
- * This function takes the inside ROI pixels
- * and fills the rest with black pixels.
+ * This function crops the frame to the ROI bounding box,
+ * then fills the pixels outside the ROI with black pixels.
  * @param input input frame from videostream.
  * @param output the trimmed ROI frame.
- * @param roiMatrix matrix to mask only the ROI.
+ * @param roiMatrix the ROI mask from initialize.
  */
 void TrimPerspective::apply(const cv::Mat& input,
                             cv::Mat& output,
                             cv::Mat& roiMatrix)
 {
-    // mask everything except the ROI
-    cv::bitwise_and(input, roiMatrix, output);
+    // the ROI can go outside of the frame, only keep the inside part
+    cv::Rect cropBox = boundingBox & cv::Rect(0, 0, input.cols, input.rows);
+    cv::Rect maskBox(cropBox.tl() - boundingBox.tl(), cropBox.size());
 
-    // throw away unnecessary black area
-    if(!isBoxInitialized)
-    {
-        // we only need to do this once with the output frame
-        cv::Mat outputGray;
-        cv::cvtColor(output, outputGray, cv::COLOR_BGR2GRAY);
-        boundingBox = cv::boundingRect(outputGray);
-        isBoxInitialized = true;
-    }
-    output = output(boundingBox);
-}
\ No newline at end of file
+    output.create(cropBox.size(), input.type());
+    output.setTo(cv::Scalar::all(0));
+    input(cropBox).copyTo(output, roiMatrix(maskBox));
+}
@@ -4,7 +4,9 @@
 #include "TransformPerspective.h"
 
 /**
- * @brief Trim strategy of TransformPerspective
+ * @brief Trim strategy of TransformPerspective.
+ * Each frame is cropped to the ROI bounding box first,
+ * then masked only inside the crop.
  */
 class TrimPerspective : public TransformPerspective
 {
@@ -18,7 +20,6 @@ public:
     apply(const cv::Mat& input, cv::Mat& output, cv::Mat& roiMatrix) override;
 
 private:
-    bool isBoxInitialized;
     cv::Rect boundingBox;
 };
 
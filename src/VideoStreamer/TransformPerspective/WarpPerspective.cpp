@@ -3,6 +3,7 @@
 
 WarpPerspective::WarpPerspective()
     : outputSize(0, 0)
+    , mappedInputSize(0, 0)
 {}
 
 /**
@@ -39,6 +40,10 @@ void WarpPerspective::initialize(cv::Mat& frame,
         static_cast<int>(cv::norm(warpPoints[1] - warpPoints[0]));
     outputSize.height =
         static_cast<int>(cv::norm(warpPoints[2] - warpPoints[0]));
+
+    // the tables are built on the first apply, once the input size is known
+    mappedInputSize = cv::Size(0, 0);
+    mappedMatrix.release();
 }
 
 /**
@@ -51,5 +56,100 @@ void WarpPerspective::apply(const cv::Mat& input,
                             cv::Mat& output,
                             cv::Mat& roiMatrix)
 {
-    cv::warpPerspective(input, output, roiMatrix, outputSize);
+    if(input.size() != mappedInputSize || isMatrixChanged(roiMatrix))
+    {
+        buildRemapTables(input.size(), roiMatrix);
+    }
+
+    if(sourceBox.empty())
+    {
+        // ROI is outside of the input, nothing to precompute
+        cv::warpPerspective(input, output, roiMatrix, outputSize);
+        return;
+    }
+
+    cv::remap(input(sourceBox),
+              output,
+              mapXY,
+              mapInterp,
+              cv::INTER_LINEAR,
+              cv::BORDER_CONSTANT);
+}
+
+/**
+ * @brief Checks if the matrix differs from the one the remap tables were
+ * built from. The values are compared, since the same buffer can be
+ * written in place and a copy of the same matrix has another buffer.
+ * @param roiMatrix matrix from getPerspectiveTransform.
+ * @return true if the remap tables must be rebuilt.
+ */
+bool WarpPerspective::isMatrixChanged(const cv::Mat& roiMatrix) const
+{
+    if(mappedMatrix.empty() || roiMatrix.size() != mappedMatrix.size() ||
+       roiMatrix.type() != mappedMatrix.type())
+        return true;
+
+    return cv::norm(roiMatrix, mappedMatrix, cv::NORM_INF) != 0;
+}
+
+/**
+ * @brief Bakes the inverse projective mapping of every output pixel
+ * into CV_16SC2 (integer coordinates) and CV_16UC1 (interpolation
+ * weights index) tables, the same fixed-point format cv::warpPerspective
+ * computes internally for every frame. The coordinates are relative to
+ * the source bounding box of the ROI, so only that crop is read.
+ * @param inputSize size of the frames that will be warped.
+ * @param roiMatrix matrix from getPerspectiveTransform.
+ */
+void WarpPerspective::buildRemapTables(const cv::Size& inputSize,
+                                       const cv::Mat& roiMatrix)
+{
+    cv::Mat inverse;
+    roiMatrix.convertTo(inverse, CV_64F);
+    inverse = inverse.inv();
+
+    std::vector<cv::Point2f> outputCorners = {
+        cv::Point2f(0, 0),
+        cv::Point2f(outputSize.width - 1, 0),
+        cv::Point2f(0, outputSize.height - 1),
+        cv::Point2f(outputSize.width - 1, outputSize.height - 1)};
+    std::vector<cv::Point2f> sourceCorners;
+    cv::perspectiveTransform(outputCorners, sourceCorners, inverse);
+
+    // one pixel margin for the bilinear neighbours
+    cv::Rect quadBox = cv::boundingRect(sourceCorners);
+    quadBox = cv::Rect(quadBox.x - 1,
+                       quadBox.y - 1,
+                       quadBox.width + 2,
+                       quadBox.height + 2);
+    sourceBox = quadBox & cv::Rect(cv::Point(0, 0), inputSize);
+
+    mappedInputSize = inputSize;
+    roiMatrix.copyTo(mappedMatrix);
+
+    if(sourceBox.empty())
+        return;
+
+    cv::Mat mapX(outputSize, CV_32FC1);
+    cv::Mat mapY(outputSize, CV_32FC1);
+    const double* m = inverse.ptr<double>();
+
+    for(int y = 0; y < outputSize.height; ++y)
+    {
+        float* rowX = mapX.ptr<float>(y);
+        float* rowY = mapY.ptr<float>(y);
+
+        for(int x = 0; x < outputSize.width; ++x)
+        {
+            double w = m[6] * x + m[7] * y + m[8];
+            w = (w != 0) ? 1.0 / w : 0.0;
+
+            rowX[x] = static_cast<float>((m[0] * x + m[1] * y + m[2]) * w -
+                                         sourceBox.x);
+            rowY[x] = static_cast<float>((m[3] * x + m[4] * y + m[5]) * w -
+                                         sourceBox.y);
+        }
+    }
+
+    cv::convertMaps(mapX, mapY, mapXY, mapInterp, CV_16SC2);
 }
\ No newline at end of file
@@ -4,7 +4,10 @@
 #include "TransformPerspective.h"
 
 /**
- * @brief Warp strategy of TransformPerspective
+ * @brief Warp strategy of TransformPerspective.
+ * The projective mapping is baked once into fixed-point remap tables,
+ * cropped to the source bounding box of the ROI, so every frame
+ * only needs a cv::remap.
  */
 class WarpPerspective : public TransformPerspective
 {
@@ -19,6 +22,18 @@ public:
 
 private:
     cv::Size outputSize;
+
+    // precomputed remap tables, rebuilt only if the input size or the
+    // values of the matrix change
+    cv::Rect sourceBox;
+    cv::Mat mapXY;
+    cv::Mat mapInterp;
+    cv::Size mappedInputSize;
+    cv::Mat mappedMatrix;
+
+    bool isMatrixChanged(const cv::Mat& roiMatrix) const;
+
+    void buildRemapTables(const cv::Size& inputSize, const cv::Mat& roiMatrix);
 };
 
 #endif
\ No newline at end of file
@@ -1,20 +1,67 @@
 #include "VideoStreamer.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
 #include <fstream>
 #include <iostream>
 #include <yaml-cpp/yaml.h>
 
+/**
+ * @brief non-member function for timestamping the decoded frames
+ * of the threaded capture mode.
+ * @return monotonic time in milliseconds.
+ */
+static double steadyClockMs()
+{
+    using namespace std::chrono;
+    return duration<double, std::milli>(
+               steady_clock::now().time_since_epoch())
+        .count();
+}
+
 VideoStreamer::VideoStreamer()
     : roiMatrixInitialized(false)
     , readCalibSuccess(false)
     , laneLength(0)
     , laneWidth(0)
+    , sharedSource(false)
+    , streamDegraded(false)
+    , reconnectAttempts(0)
+    , nextReconnectMs(0)
     , streamWindowInstance("Uninitialized Stream")
+    , liveSource(false)
+    , maxThroughput(false)
+    , hasGrabbedFrame(false)
+    , processingScale(1.0)
+    , resizeFrames(false)
+    , parallelPreprocess(false)
+    , pipelinedProcessing(false)
+    , pipelineQueueDepth(DEFAULT_PIPELINE_QUEUE_DEPTH)
+    , motionGating(false)
+    , motionGateInterval(DEFAULT_MOTION_GATE_INTERVAL)
+    , detectionBandCrop(false)
+    , detectionBandMargin(DEFAULT_DETECTION_BAND_MARGIN)
+    , componentLabelling(false)
+    , globalMatching(false)
+    , stepTiming(false)
+    , allocationStats(false)
+    , lumaCapture(false)
+    , lumaOnly(false)
+    , backendLuma(false)
+    , backendLumaSupported(false)
+    , threadedCapture(false)
+    , captureBufferSize(DEFAULT_CAPTURE_BUFFER_SIZE)
+    , captureRunning(false)
+    , captureEmptyFrames(0)
 {
     emptyFrameCount = 0;
+    exitAtStreamEnd = true;
+    streamEnded = false;
 }
 
 VideoStreamer::~VideoStreamer()
 {
+    stopCaptureThread();
     stream.release();
     if(cv::getWindowProperty(streamWindowInstance, cv::WND_PROP_VISIBLE) >= 0)
     {
@@ -22,6 +69,25 @@ VideoStreamer::~VideoStreamer()
     }
 }
 
+/**
+ * @brief non-member function for guessing the source type from its name.
+ * @param streamName the link/path passed to openVideoStream.
+ * @return true for network streams and capture devices,
+ * false for video files.
+ */
+static bool isLiveStreamName(const cv::String& streamName)
+{
+    bool isDeviceIndex =
+        !streamName.empty() &&
+        streamName.find_first_not_of("0123456789") == cv::String::npos;
+
+    bool isNetworkLink = streamName.find("://") != cv::String::npos &&
+                         streamName.rfind("file://", 0) != 0;
+
+    return isDeviceIndex || isNetworkLink ||
+           streamName.rfind("/dev/video", 0) == 0;
+}
+
 /**
  * @brief Opens a stream with cv::VideoCapture method.
  * @param streamName can be video file or link to video stream.
@@ -29,15 +95,34 @@ VideoStreamer::~VideoStreamer()
  */
 bool VideoStreamer::openVideoStream(const cv::String& streamName)
 {
-    stream.open(streamName);
+    this->streamName = streamName;
+    sharedSource = streamName.rfind(SharedFrameBuffer::LINK_PREFIX, 0) == 0;
+
+    if(sharedSource)
+    {
+        // frames decoded by the DecodeService process
+        cv::String sharedName =
+            streamName.substr(std::strlen(SharedFrameBuffer::LINK_PREFIX));
+        sharedStream.open(sharedName, SHARED_OPEN_TIMEOUT_MS);
+    }
+    else
+    {
+        openCapture();
+    }
 
-    if(!stream.isOpened())
+    if(!stream.isOpened() && !sharedStream.isOpened())
     {
         std::cerr << "Error: Unable to open stream: " << streamName << "\n";
         exit(EXIT_FAILURE);
     }
 
-    framesPerSec = stream.get(cv::CAP_PROP_FPS);
+    liveSource = isLiveStreamName(streamName);
+
+    // only FFmpeg is known to output the Y plane without RGB conversion
+    backendLumaSupported =
+        !sharedSource && (stream.getBackendName() == "FFMPEG");
+
+    framesPerSec = getStreamProperty(cv::CAP_PROP_FPS);
     if(framesPerSec == 0.0)
     {
         std::cout << "FPS information is not available for this video stream\n";
@@ -54,8 +139,10 @@ bool VideoStreamer::openVideoStream(const cv::String& streamName)
  */
 void VideoStreamer::constructStreamWindow(const cv::String& windowName)
 {
-    originalWidth = static_cast<int>(stream.get(cv::CAP_PROP_FRAME_WIDTH));
-    originalHeight = static_cast<int>(stream.get(cv::CAP_PROP_FRAME_HEIGHT));
+    originalWidth =
+        static_cast<int>(getStreamProperty(cv::CAP_PROP_FRAME_WIDTH));
+    originalHeight =
+        static_cast<int>(getStreamProperty(cv::CAP_PROP_FRAME_HEIGHT));
 
     cv::namedWindow(windowName, cv::WINDOW_NORMAL);
     cv::resizeWindow(windowName, originalWidth, originalHeight);
@@ -80,24 +167,181 @@ void VideoStreamer::resizeStreamWindow(const cv::Mat& referenceFrame)
  */
 bool VideoStreamer::getNextFrame(cv::Mat& frame)
 {
-    stream.read(frame);
+    double readStartMs = steadyClockMs();
+
+    if(threadedCapture)
+    {
+        readThreadedFrame(frame);
+    }
+    else
+    {
+        syncBackendFormat();
+        bool luma = lumaOnly;
+
+        // decode aside when the frame still needs a resize or conversion,
+        // an in place conversion would allocate a new buffer every frame
+        bool decodeAside = resizeFrames || (luma && !backendLumaSupported);
+        cv::Mat& decoded = decodeAside ? nativeFrame : frame;
+
+        if(hasGrabbedFrame)
+        {
+            // only decode the newest frame grabbed by drainStream
+            stream.retrieve(decoded);
+            hasGrabbedFrame = false;
+        }
+        else
+        {
+            readStream(decoded);
+        }
+
+        validateBackendFormat(decoded);
+
+        if(decoded.empty())
+        {
+            frame.release();
+        }
+        else
+        {
+            prepareFrame(decoded, frame, formatFrame, luma);
+        }
+    }
 
     if(frame.empty())
     {
         ++emptyFrameCount;
-        if(emptyFrameCount > MAX_EMPTY_FRAMES)
+        if(emptyFrameCount > MAX_EMPTY_FRAMES && !liveSource)
         {
+            streamEnded = true;
+            if(!exitAtStreamEnd)
+                return false;
+
             std::cerr << "Too many missing frames. Exiting...\n";
             exit(EXIT_FAILURE);
         }
+
+        // the capture thread reconnects the stream itself
+        if(!threadedCapture && isStreamLost(emptyFrameCount, readStartMs))
+        {
+            if(reconnectStream())
+            {
+                emptyFrameCount = 0;
+            }
+            else
+            {
+                // avoid busy looping while waiting for the next attempt
+                std::this_thread::sleep_for(
+                    std::chrono::milliseconds(EMPTY_FRAME_SLEEP_MS));
+            }
+        }
     }
     else
     {
         emptyFrameCount = 0;
+        markStreamRecovered();
     }
     return !frame.empty();
 }
 
+/**
+ * @brief Selects what getNextFrame does at the end of a file source
+ * (too many missing frames): exit the process, the default, or keep
+ * returning false with isStreamEnded set, for callers reading the stream
+ * from a worker thread that must stop the other threads first.
+ * @param enable true to exit at the end of the stream.
+ */
+void VideoStreamer::setExitAtStreamEnd(bool enable)
+{
+    exitAtStreamEnd = enable;
+}
+
+/**
+ * @brief Getter for the optional calibration key exit_at_stream_end,
+ * or the last setExitAtStreamEnd.
+ * @return true if getNextFrame exits the process at the end of the stream.
+ */
+bool VideoStreamer::isExitAtStreamEnd() const
+{
+    return exitAtStreamEnd;
+}
+
+/**
+ * @brief Getter for the end of a file source, see setExitAtStreamEnd.
+ * Only call this from the thread calling getNextFrame.
+ * @return true once getNextFrame gave up on the stream.
+ */
+bool VideoStreamer::isStreamEnded() const
+{
+    return streamEnded;
+}
+
+/**
+ * @brief Idle mode, call this repeatedly while no frame is needed.
+ * Grabs the next packet of a live stream without retrieving it,
+ * so the backend buffer never fills up with stale frames, and skips
+ * the color conversion and copy of a full read. The next getNextFrame
+ * then only retrieves the newest grabbed frame (snapshot).
+ * Video files are not drained since their frames are not time bound,
+ * the capture thread already drains the stream in threaded mode, and
+ * shared memory streams (DecodeService) always hold the newest frame.
+ */
+void VideoStreamer::drainStream()
+{
+    if(!liveSource || threadedCapture || sharedSource)
+        return;
+
+    if(streamDegraded && !reconnectStream())
+        return;
+
+    hasGrabbedFrame = stream.grab();
+}
+
+/**
+ * @brief Getter for the source type.
+ * @return true if the stream is a network stream or a capture device.
+ */
+bool VideoStreamer::isLiveSource() const
+{
+    return liveSource;
+}
+
+/**
+ * @brief Getter for the stream health, reported to the parent process.
+ * @return true while a lost live stream is being reconnected,
+ * until the first frame after the reconnection.
+ */
+bool VideoStreamer::isStreamDegraded() const
+{
+    return streamDegraded;
+}
+
+/**
+ * @brief Getter for the FramePacer policy of this stream.
+ * Live sources are never paced, file sources are paced to real time
+ * unless the calibration file sets "pacing: max_throughput".
+ * @return the PacingMode to initialize a FramePacer with.
+ */
+PacingMode VideoStreamer::getPacingMode() const
+{
+    if(liveSource)
+        return PacingMode::LIVE;
+
+    return maxThroughput ? PacingMode::FILE_MAX_THROUGHPUT
+                         : PacingMode::FILE_REALTIME;
+}
+
+/**
+ * @brief Getter for the position of the last read frame in the stream.
+ * @return the timestamp in milliseconds, or -1 in threaded capture mode
+ * where the stream position is ahead of the returned frame.
+ */
+double VideoStreamer::getFrameTimestamp() const
+{
+    if(threadedCapture)
+        return -1;
+
+    return getStreamProperty(cv::CAP_PROP_POS_MSEC);
+}
+
 /**
  * @brief Reads the yaml file containing the calibration data.
  * @param yamlFilename the yaml file to open.
@@ -179,6 +423,142 @@ bool VideoStreamer::readCalibrationData(const cv::String& yamlFilename)
 
         segModel = segModelNode.as<std::string>();
 
+        // optional, capture is synchronous if not specified
+        const YAML::Node& threadedNode = yamlNode["threaded_capture"];
+        if(threadedNode && threadedNode.IsScalar())
+        {
+            const YAML::Node& bufferNode = yamlNode["capture_buffer_size"];
+            size_t bufferSize = bufferNode ? bufferNode.as<size_t>()
+                                           : DEFAULT_CAPTURE_BUFFER_SIZE;
+
+            setThreadedCapture(threadedNode.as<bool>(), bufferSize);
+        }
+
+        // optional, frames are processed at native resolution if not specified
+        double scale = 1.0;
+        const YAML::Node& scaleNode = yamlNode["processing_scale"];
+        const YAML::Node& widthNode = yamlNode["processing_width"];
+        if(scaleNode && scaleNode.IsScalar())
+        {
+            scale = scaleNode.as<double>();
+        }
+        else if(widthNode && widthNode.IsScalar())
+        {
+            double nativeWidth =
+                getStreamProperty(cv::CAP_PROP_FRAME_WIDTH);
+            if(nativeWidth > 0)
+            {
+                scale = widthNode.as<double>() / nativeWidth;
+            }
+        }
+
+        if(scale <= 0.0 || scale > 1.0)
+        {
+            std::cerr << "Error: Processing scale must be in (0, 1], got "
+                      << scale << ".\n";
+            return false;
+        }
+
+        setupProcessingScale(scale);
+
+        // optional, preprocessing runs on a single core if not specified
+        const YAML::Node& parallelNode = yamlNode["parallel_preprocess"];
+        if(parallelNode && parallelNode.IsScalar())
+        {
+            parallelPreprocess = parallelNode.as<bool>();
+        }
+
+        // optional, the watcher stages run one after the other if not
+        // specified
+        const YAML::Node& pipelinedNode = yamlNode["pipelined_processing"];
+        if(pipelinedNode && pipelinedNode.IsScalar())
+        {
+            const YAML::Node& depthNode = yamlNode["pipeline_queue_depth"];
+            pipelinedProcessing = pipelinedNode.as<bool>();
+            pipelineQueueDepth = depthNode ? depthNode.as<size_t>()
+                                           : DEFAULT_PIPELINE_QUEUE_DEPTH;
+        }
+
+        // optional, every frame goes through the tracking pipeline if not
+        // specified
+        const YAML::Node& gatingNode = yamlNode["motion_gating"];
+        if(gatingNode && gatingNode.IsScalar())
+        {
+            const YAML::Node& intervalNode = yamlNode["motion_gate_interval"];
+            motionGating = gatingNode.as<bool>();
+            motionGateInterval = intervalNode ? intervalNode.as<int>()
+                                              : DEFAULT_MOTION_GATE_INTERVAL;
+        }
+
+        // optional, the whole ROI is preprocessed if not specified
+        const YAML::Node& cropNode = yamlNode["detection_band_crop"];
+        if(cropNode && cropNode.IsScalar())
+        {
+            const YAML::Node& marginNode = yamlNode["detection_band_margin"];
+            detectionBandCrop = cropNode.as<bool>();
+            detectionBandMargin = marginNode ? marginNode.as<int>()
+                                             : DEFAULT_DETECTION_BAND_MARGIN;
+        }
+
+        // optional, the hulls are detected from the contours if not
+        // specified
+        const YAML::Node& labellingNode = yamlNode["component_labelling"];
+        if(labellingNode && labellingNode.IsScalar())
+        {
+            componentLabelling = labellingNode.as<bool>();
+        }
+
+        // optional, each trackable takes the first similar blob if not
+        // specified
+        const YAML::Node& matchingNode = yamlNode["global_matching"];
+        if(matchingNode && matchingNode.IsScalar())
+        {
+            globalMatching = matchingNode.as<bool>();
+        }
+
+        // optional, the preprocessing steps are not timed if not specified
+        const YAML::Node& timingNode = yamlNode["step_timing"];
+        if(timingNode && timingNode.IsScalar())
+        {
+            stepTiming = timingNode.as<bool>();
+        }
+
+        // optional, the cv::Mat allocations are not counted if not specified
+        const YAML::Node& allocationNode = yamlNode["allocation_stats"];
+        if(allocationNode && allocationNode.IsScalar())
+        {
+            allocationStats = allocationNode.as<bool>();
+        }
+
+        // optional, the process exits at the end of a file if not specified
+        const YAML::Node& exitNode = yamlNode["exit_at_stream_end"];
+        if(exitNode && exitNode.IsScalar())
+        {
+            exitAtStreamEnd = exitNode.as<bool>();
+        }
+
+        // optional, frames are decoded to BGR if not specified
+        const YAML::Node& lumaNode = yamlNode["luma_capture"];
+        if(lumaNode && lumaNode.IsScalar())
+        {
+            lumaCapture = lumaNode.as<bool>();
+        }
+
+        // optional, file sources are replayed in real time if not specified
+        const YAML::Node& pacingNode = yamlNode["pacing"];
+        if(pacingNode && pacingNode.IsScalar())
+        {
+            std::string pacing = pacingNode.as<std::string>();
+            if(pacing != "realtime" && pacing != "max_throughput")
+            {
+                std::cerr << "Error: Unknown pacing: " << pacing
+                          << ", expected realtime or max_throughput.\n";
+                return false;
+            }
+
+            maxThroughput = (pacing == "max_throughput");
+        }
+
         fin.close();
         readCalibSuccess = true;
     }
@@ -202,6 +582,127 @@ double VideoStreamer::getFPS() const
     return framesPerSec;
 }
 
+/**
+ * @brief Getter for the processing scale, from the optional calibration
+ * keys processing_scale or processing_width. Frames from getNextFrame
+ * and the ROI points are already scaled by it, the pipeline config is
+ * scaled by PipelineDirector::scalePipeline.
+ * @return frame size relative to the native stream resolution.
+ */
+double VideoStreamer::getProcessingScale() const
+{
+    return processingScale;
+}
+
+/**
+ * @brief Getter for the optional calibration key parallel_preprocess.
+ * @return true if the preprocessing pipeline should split the frame
+ * in row bands processed across the cores.
+ */
+bool VideoStreamer::isParallelPreprocess() const
+{
+    return parallelPreprocess;
+}
+
+/**
+ * @brief Getter for the optional calibration key pipelined_processing.
+ * @return true if the watcher should run capture/warp, preprocessing and
+ * hull detection each on its own thread.
+ */
+bool VideoStreamer::isPipelinedProcessing() const
+{
+    return pipelinedProcessing;
+}
+
+/**
+ * @brief Getter for the optional calibration key pipeline_queue_depth.
+ * @return the capacity of each queue between two pipelined stages.
+ */
+size_t VideoStreamer::getPipelineQueueDepth() const
+{
+    return pipelineQueueDepth;
+}
+
+/**
+ * @brief Getter for the optional calibration key motion_gating.
+ * @return true if the watcher should skip the tracking pipeline on
+ * frames without motion, and check for a frozen feed.
+ */
+bool VideoStreamer::isMotionGating() const
+{
+    return motionGating;
+}
+
+/**
+ * @brief Getter for the optional calibration key motion_gate_interval.
+ * @return one frame without motion in this many is still processed,
+ * to keep the background model updated.
+ */
+int VideoStreamer::getMotionGateInterval() const
+{
+    return motionGateInterval;
+}
+
+/**
+ * @brief Getter for the optional calibration key detection_band_crop.
+ * @return true if the watcher should only preprocess the rows around the
+ * detection boundaries of the HullDetector.
+ */
+bool VideoStreamer::isDetectionBandCrop() const
+{
+    return detectionBandCrop;
+}
+
+/**
+ * @brief Getter for the optional calibration key detection_band_margin.
+ * @return the %height of the ROI kept above and below the detection band,
+ * so vehicles crossing the boundaries are not cut at the band edge.
+ */
+int VideoStreamer::getDetectionBandMargin() const
+{
+    return detectionBandMargin;
+}
+
+/**
+ * @brief Getter for the optional calibration key component_labelling.
+ * @return true if the watcher should find the blobs with
+ * connectedComponentsWithStats instead of the contours.
+ */
+bool VideoStreamer::isComponentLabelling() const
+{
+    return componentLabelling;
+}
+
+/**
+ * @brief Getter for the optional calibration key global_matching.
+ * @return true if the tracker should match all the trackables at once,
+ * with a minimum cost assignment, instead of first fit.
+ */
+bool VideoStreamer::isGlobalMatching() const
+{
+    return globalMatching;
+}
+
+/**
+ * @brief Getter for the optional calibration key step_timing.
+ * @return true if the watcher should record the latency of each
+ * preprocessing step, and report it after every tracking sample.
+ */
+bool VideoStreamer::isStepTiming() const
+{
+    return stepTiming;
+}
+
+/**
+ * @brief Getter for the optional calibration key allocation_stats.
+ * @return true if the watcher should count the cv::Mat allocations of
+ * each frame, and report them after every sample.
+ */
+bool VideoStreamer::isAllocationStats() const
+{
+    return allocationStats;
+}
+
 /**
  * @brief Getter for laneLength. Need to first do readCalibrationData
  * @return the total length of the lanes, in meters.
@@ -237,6 +738,238 @@ cv::String VideoStreamer::getSegModel() const
     return segModel;
 }
 
+/**
+ * @brief Switches between luma-only (CV_8UC1) and BGR frames.
+ * Only has an effect if luma_capture is enabled in the calibration file.
+ * When supported, the Y plane is taken straight from the decoder,
+ * otherwise frames are converted to grey right after decoding (in the
+ * capture thread when threaded), before the perspective transform.
+ * The grayscale pipeline step is then a no-op.
+ * @param enable true for tracking, false when BGR is needed (e.g. YOLO).
+ */
+void VideoStreamer::setLumaOnly(bool enable)
+{
+    lumaOnly = enable && lumaCapture;
+}
+
+/**
+ * @brief Getter for the current frame format.
+ * @return true if getNextFrame returns luma-only frames.
+ */
+bool VideoStreamer::isLumaOnly() const
+{
+    return lumaOnly;
+}
+
+/**
+ * @brief Enables/disables the threaded capture mode, where a dedicated
+ * thread owns the stream and publishes decoded frames into a small ring.
+ * getNextFrame then always returns the newest frame, and never stalls
+ * longer than two frame intervals once the first frame has arrived.
+ * The capture thread is started on the first getNextFrame call.
+ * Only live sources are read from a capture thread: a video file decodes
+ * faster than it is processed, so the ring would drop most of its frames,
+ * and its end would never be detected.
+ * Call this after openVideoStream.
+ * @param enable true to read the stream from a capture thread.
+ * @param bufferSize number of frames the ring can hold.
+ */
+void VideoStreamer::setThreadedCapture(bool enable, size_t bufferSize)
+{
+    stopCaptureThread();
+
+    if(enable && !liveSource)
+    {
+        std::cerr << "Warning: Threaded capture ignored, not a live stream: "
+                  << streamName << "\n";
+    }
+
+    threadedCapture = enable && liveSource;
+    captureBufferSize = bufferSize;
+    frameRing.reset(captureBufferSize);
+
+    latestFrame.release();
+    captureStats = CaptureStats();
+}
+
+/**
+ * @brief Getter for the capture mode.
+ * @return true if frames are read from a capture thread.
+ */
+bool VideoStreamer::isThreadedCapture() const
+{
+    return threadedCapture;
+}
+
+/**
+ * @brief Getter for the dropped/duplicated/late frame counters.
+ * Only updated in the threaded capture mode.
+ * @return the counters since the capture mode was set.
+ */
+CaptureStats VideoStreamer::getCaptureStats() const
+{
+    CaptureStats stats = captureStats;
+    stats.droppedFrames = frameRing.getDroppedCount();
+
+    return stats;
+}
+
+/**
+ * @brief Formats the capture counters, see getCaptureStats. Only call
+ * this from the thread calling getNextFrame.
+ * @return one line with the counters, ending with a newline.
+ */
+std::string VideoStreamer::getCaptureReport() const
+{
+    CaptureStats stats = getCaptureStats();
+
+    return "Threaded capture frames: " +
+           std::to_string(stats.droppedFrames) + " dropped, " +
+           std::to_string(stats.duplicatedFrames) + " duplicated, " +
+           std::to_string(stats.lateFrames) + " late\n";
+}
+
+/**
+ * @brief Sets up the reduced processing resolution. The capture backend
+ * is asked for the reduced size first (e.g. capture devices), otherwise
+ * every frame is downscaled right after decoding. The calibration points,
+ * given at native resolution, are rescaled to match.
+ * @param scale frame size relative to the native stream resolution.
+ */
+void VideoStreamer::setupProcessingScale(double scale)
+{
+    processingScale = scale;
+    resizeFrames = false;
+
+    if(scale == 1.0)
+        return;
+
+    double nativeWidth = getStreamProperty(cv::CAP_PROP_FRAME_WIDTH);
+    double nativeHeight = getStreamProperty(cv::CAP_PROP_FRAME_HEIGHT);
+    processingSize = cv::Size(cvRound(nativeWidth * scale),
+                              cvRound(nativeHeight * scale));
+
+    bool isBackendScaled =
+        stream.set(cv::CAP_PROP_FRAME_WIDTH, processingSize.width) &&
+        stream.set(cv::CAP_PROP_FRAME_HEIGHT, processingSize.height) &&
+        stream.get(cv::CAP_PROP_FRAME_WIDTH) == processingSize.width &&
+        stream.get(cv::CAP_PROP_FRAME_HEIGHT) == processingSize.height;
+
+    if(!isBackendScaled)
+    {
+        // the backend may have switched to another mode, restore it
+        stream.set(cv::CAP_PROP_FRAME_WIDTH, nativeWidth);
+        stream.set(cv::CAP_PROP_FRAME_HEIGHT, nativeHeight);
+        resizeFrames = true;
+    }
+
+    for(auto& point : roiPoints)
+    {
+        point.x *= scale;
+        point.y *= scale;
+    }
+}
+
+/**
+ * @brief Asks the backend for the currently requested frame format.
+ * Only call this from the thread reading the stream.
+ */
+void VideoStreamer::syncBackendFormat()
+{
+    bool luma = lumaOnly;
+    if(luma == backendLuma)
+        return;
+
+    backendLuma = luma;
+    if(backendLumaSupported)
+    {
+        stream.set(cv::CAP_PROP_CONVERT_RGB, luma ? 0 : 1);
+    }
+}
+
+/**
+ * @brief Checks that the backend really outputs the Y plane when asked,
+ * older backends may return raw data instead. If not, the backend stays
+ * in BGR mode, and the frames are converted after decoding.
+ * Only call this from the thread reading the stream.
+ * @param decoded a frame read while luma-only was requested.
+ */
+void VideoStreamer::validateBackendFormat(const cv::Mat& decoded)
+{
+    if(!backendLuma || !backendLumaSupported || decoded.empty())
+        return;
+
+    bool isLumaPlane = decoded.type() == CV_8UC1 &&
+                       decoded.cols == stream.get(cv::CAP_PROP_FRAME_WIDTH) &&
+                       decoded.rows == stream.get(cv::CAP_PROP_FRAME_HEIGHT);
+
+    if(decoded.channels() == 3 || isLumaPlane)
+        return;
+
+    std::cerr << "Warning: Luma capture not supported by the backend, "
+                 "converting after decoding instead.\n";
+    stream.set(cv::CAP_PROP_CONVERT_RGB, 1);
+    backendLumaSupported = false;
+}
+
+/**
+ * @brief Copies the source to the frame in the requested format,
+ * converting it if needed. The frame buffer is reused when it already
+ * has the output size and type.
+ * @param source the decoded frame, can be the frame itself
+ * (no-op if it is already in the requested format).
+ * @param frame the output frame.
+ * @param luma true for CV_8UC1, false for BGR.
+ */
+void VideoStreamer::matchFrameFormat(const cv::Mat& source,
+                                     cv::Mat& frame,
+                                     bool luma) const
+{
+    if(luma && source.channels() == 3)
+    {
+        cv::cvtColor(source, frame, cv::COLOR_BGR2GRAY);
+    }
+    else if(!luma && source.channels() == 1)
+    {
+        cv::cvtColor(source, frame, cv::COLOR_GRAY2BGR);
+    }
+    else
+    {
+        source.copyTo(frame);
+    }
+}
+
+/**
+ * @brief Brings a decoded frame to the processing size and format.
+ * Converts before resizing, so only the luma plane is resized.
+ * @param decoded the non-empty decoded frame.
+ * @param frame the output frame, can be the decoded frame itself
+ * when no resize is needed.
+ * @param formatScratch buffer for the converted frame before resizing,
+ * owned by the calling thread.
+ * @param luma true for CV_8UC1, false for BGR.
+ */
+void VideoStreamer::prepareFrame(const cv::Mat& decoded,
+                                 cv::Mat& frame,
+                                 cv::Mat& formatScratch,
+                                 bool luma) const
+{
+    if(!resizeFrames)
+    {
+        matchFrameFormat(decoded, frame, luma);
+        return;
+    }
+
+    const cv::Mat* resizeSource = &decoded;
+    if(decoded.channels() != (luma ? 1 : 3))
+    {
+        matchFrameFormat(decoded, formatScratch, luma);
+        resizeSource = &formatScratch;
+    }
+
+    cv::resize(*resizeSource, frame, processingSize, 0, 0, cv::INTER_AREA);
+}
+
 /**
  * @brief Initialize TransformPerspective strategy.
  * @param frame need a reference for frame type and size.
@@ -288,6 +1021,23 @@ bool VideoStreamer::applyFrameRoi(cv::Mat& frame,
 
 cv::Mat VideoStreamer::applyPerspective(cv::Mat inputFrame,
                                         TransformPerspective& perspective)
+{
+    cv::Mat outputFrame;
+    applyPerspective(inputFrame, outputFrame, perspective);
+
+    return outputFrame;
+}
+
+/**
+ * @brief Applies the TransformPerspective strategy to a frame
+ * not read from the stream, e.g. a segmentation mask.
+ * @param inputFrame frame with the same size as the stream frames.
+ * @param outputFrame the ROI output, its buffer is reused between calls.
+ * @param perspective same strategy used in initializePerspectiveTransform.
+ */
+void VideoStreamer::applyPerspective(const cv::Mat& inputFrame,
+                                     cv::Mat& outputFrame,
+                                     TransformPerspective& perspective)
 {
     if(!roiMatrixInitialized)
     {
@@ -295,8 +1045,277 @@ cv::Mat VideoStreamer::applyPerspective(cv::Mat inputFrame,
         exit(EXIT_FAILURE);
     }
 
-    cv::Mat outputFrame;
     perspective.apply(inputFrame, outputFrame, roiMatrix);
+}
 
-    return outputFrame;
-}
\ No newline at end of file
+/**
+ * @brief Opens the cv::VideoCapture of the stream with bounded
+ * open/read timeouts, so a lost camera is noticed and reconnected
+ * instead of blocking the thread reading the stream.
+ * @return true if successfully opened.
+ */
+bool VideoStreamer::openCapture()
+{
+    const std::vector<int> params = {cv::CAP_PROP_OPEN_TIMEOUT_MSEC,
+                                     STREAM_OPEN_TIMEOUT_MS,
+                                     cv::CAP_PROP_READ_TIMEOUT_MSEC,
+                                     STREAM_READ_TIMEOUT_MS};
+
+    return stream.open(streamName, cv::CAP_ANY, params);
+}
+
+/**
+ * @brief Reads the next frame from the opened source,
+ * cv::VideoCapture or the shared memory of the DecodeService.
+ * Only call this from the thread reading the stream.
+ * @param frame the matrix reference to store the frame.
+ * @return false if no frame could be read.
+ */
+bool VideoStreamer::readStream(cv::Mat& frame)
+{
+    if(sharedSource)
+    {
+        if(sharedStream.read(frame, SHARED_READ_TIMEOUT_MS))
+            return true;
+
+        frame.release();
+        return false;
+    }
+
+    return stream.read(frame);
+}
+
+/**
+ * @brief Gets a property of the opened source, see readStream.
+ * @param propId a cv::VideoCaptureProperties value.
+ * @return the property value, 0 if not available.
+ */
+double VideoStreamer::getStreamProperty(int propId) const
+{
+    return sharedSource ? sharedStream.get(propId) : stream.get(propId);
+}
+
+/**
+ * @brief Checks if a live stream is lost after a failed read: a read that
+ * waited for the whole read timeout, or a few failed reads in a row.
+ * The end of file threshold (MAX_EMPTY_FRAMES) would take a minute of
+ * blocking reads on a dead camera before the first reconnection.
+ * @param failedReads number of failed reads in a row, this one included.
+ * @param readStartMs the time (steady clock, ms) the failed read started.
+ * @return true if the stream should be reconnected.
+ */
+bool VideoStreamer::isStreamLost(int failedReads, double readStartMs) const
+{
+    if(!liveSource)
+        return false;
+
+    return failedReads >= MAX_LIVE_FAILED_READS ||
+           steadyClockMs() - readStartMs >= STREAM_READ_TIMEOUT_MS;
+}
+
+/**
+ * @brief Reconnects a lost live stream in place, with an exponential
+ * backoff between attempts. Returns right away while the next attempt
+ * is not due, so the caller keeps answering the parent process, and
+ * the watcher keeps its tracker and background model for when the
+ * stream comes back. Only call this from the thread reading the stream.
+ * @return true if the stream was reopened by this call.
+ */
+bool VideoStreamer::reconnectStream()
+{
+    double nowMs = steadyClockMs();
+
+    if(!streamDegraded)
+    {
+        std::cerr << "Warning: Stream lost, reconnecting: " << streamName
+                  << "\n";
+        streamDegraded = true;
+        reconnectAttempts = 0;
+        nextReconnectMs = nowMs;
+    }
+
+    if(nowMs < nextReconnectMs)
+        return false;
+
+    ++reconnectAttempts;
+    if(!reopenStream())
+    {
+        int backoffShift = std::min(reconnectAttempts - 1, 16);
+        int delayMs = std::min(RECONNECT_BASE_DELAY_MS << backoffShift,
+                               RECONNECT_MAX_DELAY_MS);
+        nextReconnectMs = steadyClockMs() + delayMs;
+
+        std::cerr << "Warning: Reconnect attempt " << reconnectAttempts
+                  << " failed, retrying in " << delayMs << " ms: "
+                  << streamName << "\n";
+        return false;
+    }
+
+    // emptyFrameCount belongs to the reading thread, getNextFrame resets it
+    captureEmptyFrames = 0;
+    return true;
+}
+
+/**
+ * @brief Reopens the stream, restoring the capture settings
+ * (processing scale, luma-only format) the new capture starts without.
+ * Only call this from the thread reading the stream.
+ * @return true if the stream is open again.
+ */
+bool VideoStreamer::reopenStream()
+{
+    // the DecodeService reopens the camera itself,
+    // the shared memory of the stream stays valid in the meantime
+    if(sharedSource)
+        return sharedStream.isOpened();
+
+    stream.release();
+    hasGrabbedFrame = false;
+
+    if(!openCapture())
+        return false;
+
+    if(processingScale != 1.0 && !resizeFrames)
+    {
+        stream.set(cv::CAP_PROP_FRAME_WIDTH, processingSize.width);
+        stream.set(cv::CAP_PROP_FRAME_HEIGHT, processingSize.height);
+    }
+
+    // the new capture outputs BGR, syncBackendFormat re-applies luma
+    backendLuma = false;
+
+    return true;
+}
+
+/**
+ * @brief Clears the degraded state on the first frame after a loss.
+ */
+void VideoStreamer::markStreamRecovered()
+{
+    if(streamDegraded.exchange(false))
+    {
+        std::cout << "Stream reconnected after " << reconnectAttempts
+                  << " attempt(s): " << streamName << "\n";
+    }
+}
+
+/**
+ * @brief Starts the capture thread. From here on,
+ * only the capture thread should access the stream.
+ */
+void VideoStreamer::startCaptureThread()
+{
+    if(captureRunning)
+        return;
+
+    captureEmptyFrames = 0;
+    captureRunning = true;
+    captureThread = std::thread(&VideoStreamer::captureLoop, this);
+}
+
+/**
+ * @brief Stops and joins the capture thread, if running.
+ */
+void VideoStreamer::stopCaptureThread()
+{
+    if(!captureRunning)
+        return;
+
+    captureRunning = false;
+    frameRing.close();
+
+    if(captureThread.joinable())
+    {
+        captureThread.join();
+    }
+}
+
+/**
+ * @brief The capture thread loop. Decodes directly into a ring slot,
+ * so the stream is drained as fast as the camera sends frames,
+ * regardless of how slow the processing is.
+ */
+void VideoStreamer::captureLoop()
+{
+    while(captureRunning)
+    {
+        syncBackendFormat();
+        bool luma = backendLuma;
+
+        cv::Mat& slot = frameRing.acquireWriteSlot();
+        bool decodeAside = resizeFrames || (luma && !backendLumaSupported);
+        cv::Mat& decoded = decodeAside ? captureNativeFrame : slot;
+
+        double readStartMs = steadyClockMs();
+        if(!readStream(decoded) || decoded.empty())
+        {
+            ++captureEmptyFrames;
+
+            if(isStreamLost(captureEmptyFrames, readStartMs))
+            {
+                reconnectStream();
+            }
+
+            // avoid busy looping on a dead stream
+            std::this_thread::sleep_for(
+                std::chrono::milliseconds(EMPTY_FRAME_SLEEP_MS));
+            continue;
+        }
+
+        validateBackendFormat(decoded);
+        prepareFrame(decoded, slot, captureFormatFrame, luma);
+
+        captureEmptyFrames = 0;
+        markStreamRecovered();
+        frameRing.commitWriteSlot(steadyClockMs());
+    }
+}
+
+/**
+ * @brief Reads the newest frame published by the capture thread.
+ * If no new frame arrives within two frame intervals,
+ * the previous frame is returned again (counted as duplicated).
+ * @param frame the matrix reference to store the frame,
+ * left empty if the capture thread keeps failing to read the stream.
+ */
+void VideoStreamer::readThreadedFrame(cv::Mat& frame)
+{
+    startCaptureThread();
+
+    double frameIntervalMs = 1000.0 / framesPerSec;
+    int timeoutMs = latestFrame.empty()
+                        ? FIRST_FRAME_TIMEOUT_MS
+                        : static_cast<int>(2 * frameIntervalMs);
+
+    double decodeTimeMs = 0;
+    if(frameRing.popLatest(latestFrame, decodeTimeMs, timeoutMs))
+    {
+        if(steadyClockMs() - decodeTimeMs > frameIntervalMs)
+        {
+            ++captureStats.lateFrames;
+        }
+    }
+    else if(!latestFrame.empty())
+    {
+        ++captureStats.duplicatedFrames;
+    }
+
+    if(captureEmptyFrames >= MAX_LIVE_FAILED_READS || streamDegraded ||
+       latestFrame.empty())
+    {
+        frame.release();
+        return;
+    }
+
+    bool luma = lumaOnly;
+    if(!luma && latestFrame.channels() == 1)
+    {
+        // decoded before switching back to BGR, wait for a newer frame
+        frameRing.popLatest(latestFrame,
+                            decodeTimeMs,
+                            static_cast<int>(2 * frameIntervalMs));
+    }
+
+    // copy, since the ring reuses the buffer of latestFrame
+    matchFrameFormat(latestFrame, frame, luma);
+}
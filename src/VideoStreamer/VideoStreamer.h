@@ -1,8 +1,27 @@
 #ifndef VIDEO_STREAMER_H
 #define VIDEO_STREAMER_H
 
+#include "FramePacer.h"
+#include "FrameRingBuffer.h"
+#include "SharedFrameBuffer.h"
 #include "TransformPerspective.h"
+#include <atomic>
 #include <opencv2/opencv.hpp>
+#include <string>
+#include <thread>
+
+/**
+ * @brief Counters of the threaded capture mode.
+ * droppedFrames: decoded frames replaced by a newer one before being read.
+ * duplicatedFrames: reads that got the previous frame again (no new frame).
+ * lateFrames: frames read more than one frame interval after decoding.
+ */
+struct CaptureStats
+{
+    uint64_t droppedFrames = 0;
+    uint64_t duplicatedFrames = 0;
+    uint64_t lateFrames = 0;
+};
 
 /**
  * @brief Class for reading/getting frames from a stream,
@@ -20,13 +39,41 @@ public:
     void resizeStreamWindow(const cv::Mat& referenceFrame);
 
     bool getNextFrame(cv::Mat& frame);
+    void setExitAtStreamEnd(bool enable);
+    bool isExitAtStreamEnd() const;
+    bool isStreamEnded() const;
+    void drainStream();
+    bool isLiveSource() const;
+    bool isStreamDegraded() const;
+    PacingMode getPacingMode() const;
+    double getFrameTimestamp() const;
     bool readCalibrationData(const cv::String& yamlFilename);
 
     double getFPS() const;
     double getLaneLength() const;
     double getLaneWidth() const;
+    double getProcessingScale() const;
+    bool isParallelPreprocess() const;
+    bool isPipelinedProcessing() const;
+    size_t getPipelineQueueDepth() const;
+    bool isMotionGating() const;
+    int getMotionGateInterval() const;
+    bool isDetectionBandCrop() const;
+    int getDetectionBandMargin() const;
+    bool isComponentLabelling() const;
+    bool isGlobalMatching() const;
+    bool isStepTiming() const;
+    bool isAllocationStats() const;
     cv::String getSegModel() const;
 
+    void setLumaOnly(bool enable);
+    bool isLumaOnly() const;
+
+    void setThreadedCapture(bool enable, size_t bufferSize);
+    bool isThreadedCapture() const;
+    CaptureStats getCaptureStats() const;
+    std::string getCaptureReport() const;
+
     void initializePerspectiveTransform(cv::Mat& frame,
                                         TransformPerspective& perspective);
     bool applyFrameRoi(cv::Mat& frame,
@@ -35,6 +82,9 @@ public:
 
     cv::Mat applyPerspective(cv::Mat inputFrame,
                              TransformPerspective& perspective);
+    void applyPerspective(const cv::Mat& inputFrame,
+                          cv::Mat& outputFrame,
+                          TransformPerspective& perspective);
 
 protected:
     bool readCalibSuccess; // used also in CalibrateVideoStreamer
@@ -44,11 +94,53 @@ protected:
 
 private:
     static constexpr int MAX_EMPTY_FRAMES = 30;
+    static constexpr size_t DEFAULT_CAPTURE_BUFFER_SIZE = 4;
+    static constexpr size_t DEFAULT_PIPELINE_QUEUE_DEPTH = 2;
+    static constexpr int DEFAULT_MOTION_GATE_INTERVAL = 10;
+    static constexpr int DEFAULT_DETECTION_BAND_MARGIN = 5;
+    static constexpr int FIRST_FRAME_TIMEOUT_MS = 5000;
+    static constexpr int EMPTY_FRAME_SLEEP_MS = 10;
+    static constexpr int SHARED_OPEN_TIMEOUT_MS = 30000;
+    static constexpr int SHARED_READ_TIMEOUT_MS = 2000;
+    static constexpr int STREAM_OPEN_TIMEOUT_MS = 5000;
+    static constexpr int STREAM_READ_TIMEOUT_MS = 2000;
+
+    // only accessed by the thread calling getNextFrame, the capture
+    // thread counts its failed reads in captureEmptyFrames
     int emptyFrameCount;
 
+    // end of a file source, the process exits there unless disabled
+    bool exitAtStreamEnd;
+    bool streamEnded;
+
     double framesPerSec;
 
+    cv::String streamName;
     cv::VideoCapture stream;
+
+    // frames from the DecodeService, for "shm://<name>" stream links
+    bool sharedSource;
+    SharedFrameBuffer sharedStream;
+
+    bool openCapture();
+    bool readStream(cv::Mat& frame);
+    double getStreamProperty(int propId) const;
+
+    // in place reconnection of a lost live stream, owned by the thread
+    // reading the stream, so the watcher keeps its tracker/background
+    static constexpr int RECONNECT_BASE_DELAY_MS = 500;
+    static constexpr int RECONNECT_MAX_DELAY_MS = 30000;
+    // each failed read of a dead stream can block for the read timeout
+    static constexpr int MAX_LIVE_FAILED_READS = 3;
+    std::atomic<bool> streamDegraded;
+    int reconnectAttempts;
+    double nextReconnectMs;
+
+    bool isStreamLost(int failedReads, double readStartMs) const;
+    bool reconnectStream();
+    bool reopenStream();
+    void markStreamRecovered();
+
     cv::String streamWindowInstance;
 
     int originalWidth;
@@ -59,6 +151,83 @@ private:
     cv::String segModel;
 
     bool roiMatrixInitialized;
+
+    // source type, for idle draining and pacing
+    bool liveSource;
+    bool maxThroughput;
+
+    // idle mode, frames are grabbed but only the newest is decoded
+    bool hasGrabbedFrame;
+
+    // processing resolution, relative to the native stream resolution
+    double processingScale;
+    cv::Size processingSize;
+    bool resizeFrames;
+    cv::Mat nativeFrame;
+    cv::Mat captureNativeFrame;
+
+    void setupProcessingScale(double scale);
+
+    // preprocessing split in row bands across the cores, see FusedPipeline
+    bool parallelPreprocess;
+
+    // watcher stages on their own threads, connected by bounded queues
+    bool pipelinedProcessing;
+    size_t pipelineQueueDepth;
+
+    // still frames skip the tracking pipeline, see MotionGate
+    bool motionGating;
+    int motionGateInterval;
+
+    // only the detection band of the ROI is preprocessed, see HullDetector
+    bool detectionBandCrop;
+    int detectionBandMargin;
+
+    // blobs found in one labelling sweep, see HullDetector
+    bool componentLabelling;
+
+    // trackables matched by a minimum cost assignment, see HullTracker
+    bool globalMatching;
+
+    // per step latency histograms of the preprocessing, see StepTimings
+    bool stepTiming;
+
+    // cv::Mat allocations per frame, see FramePool::installAllocationCounter
+    bool allocationStats;
+
+    // luma-only capture, backendLuma is owned by the thread reading the stream
+    bool lumaCapture;
+    std::atomic<bool> lumaOnly;
+    bool backendLuma;
+    bool backendLumaSupported;
+
+    cv::Mat formatFrame;
+    cv::Mat captureFormatFrame;
+
+    void syncBackendFormat();
+    void validateBackendFormat(const cv::Mat& decoded);
+    void matchFrameFormat(const cv::Mat& source,
+                          cv::Mat& frame,
+                          bool luma) const;
+    void prepareFrame(const cv::Mat& decoded,
+                      cv::Mat& frame,
+                      cv::Mat& formatScratch,
+                      bool luma) const;
+
+    // threaded capture mode, the capture thread owns the stream once started
+    bool threadedCapture;
+    size_t captureBufferSize;
+    std::thread captureThread;
+    std::atomic<bool> captureRunning;
+    std::atomic<int> captureEmptyFrames;
+    FrameRingBuffer frameRing;
+    cv::Mat latestFrame;
+    CaptureStats captureStats;
+
+    void startCaptureThread();
+    void stopCaptureThread();
+    void captureLoop();
+    void readThreadedFrame(cv::Mat& frame);
 };
 
 #endif
\ No newline at end of file
@@ -15,12 +15,6 @@ void PedestrianGui::initialize(const std::string& streamName,
 
     videoStreamer.constructStreamWindow(streamWindow);
 
-    // there is a bug where the matrix sizes or types do not match,
-    // as workaround for now, process one frame of warp to initialize correctly,
-    videoStreamer.initializePerspectiveTransform(inputFrame, warpPerspective);
-    videoStreamer.applyFrameRoi(inputFrame, trimmedFrame, warpPerspective);
-
-    // then we can use the trim after one warp.
     videoStreamer.initializePerspectiveTransform(inputFrame, trimPerspective);
     videoStreamer.applyFrameRoi(inputFrame, trimmedFrame, trimPerspective);
 
@@ -41,7 +35,17 @@ void PedestrianGui::display()
     cv::waitKey(1);
 }
 
+void PedestrianGui::idle()
+{
+    videoStreamer.drainStream();
+}
+
 int PedestrianGui::getInstanceCount()
 {
     return segmentation.getDetectionResultSize();
 }
+
+bool PedestrianGui::isStreamDegraded()
+{
+    return videoStreamer.isStreamDegraded();
+}
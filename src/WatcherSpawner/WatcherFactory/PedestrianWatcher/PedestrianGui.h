@@ -8,7 +8,6 @@
 #include "SegmentationMask.h"
 #include "TrimPerspective.h"
 #include "VideoStreamer.h"
-#include "WarpPerspective.h"
 
 class PedestrianGui : public Gui
 {
@@ -17,12 +16,13 @@ public:
                     const std::string& calibName) override;
 
     void display() override;
+    void idle() override;
     int getInstanceCount() override;
+    bool isStreamDegraded() override;
 
 private:
     VideoStreamer videoStreamer;
     TrimPerspective trimPerspective;
-    WarpPerspective warpPerspective;
     SegmentationMask segmentation;
 
     std::string streamWindow;
@@ -11,12 +11,6 @@ void PedestrianHeadless::initialize(const std::string& streamName,
         return;
     }
 
-    // there is a bug where the matrix sizes or types do not match,
-    // as workaround for now, process one frame of warp to initialize correctly,
-    videoStreamer.initializePerspectiveTransform(inputFrame, warpPerspective);
-    videoStreamer.applyFrameRoi(inputFrame, trimmedFrame, warpPerspective);
-
-    // then we can use the trim after one warp.
     videoStreamer.initializePerspectiveTransform(inputFrame, trimPerspective);
     videoStreamer.applyFrameRoi(inputFrame, trimmedFrame, trimPerspective);
 
@@ -35,7 +29,17 @@ void PedestrianHeadless::process()
     cv::Mat segMask = segmentation.generateMask(trimmedFrame);
 }
 
+void PedestrianHeadless::idle()
+{
+    videoStreamer.drainStream();
+}
+
 int PedestrianHeadless::getInstanceCount()
 {
     return segmentation.getDetectionResultSize();
-}
\ No newline at end of file
+}
+
+bool PedestrianHeadless::isStreamDegraded()
+{
+    return videoStreamer.isStreamDegraded();
+}
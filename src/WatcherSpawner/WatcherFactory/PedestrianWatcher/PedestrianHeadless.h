@@ -8,7 +8,6 @@
 #include "SegmentationMask.h"
 #include "TrimPerspective.h"
 #include "VideoStreamer.h"
-#include "WarpPerspective.h"
 
 class PedestrianHeadless : public Headless
 {
@@ -17,12 +16,13 @@ public:
                     const std::string& calibName) override;
 
     void process() override;
+    void idle() override;
     int getInstanceCount() override;
+    bool isStreamDegraded() override;
 
 private:
     VideoStreamer videoStreamer;
     TrimPerspective trimPerspective;
-    WarpPerspective warpPerspective;
     SegmentationMask segmentation;
 
     std::string segModel;
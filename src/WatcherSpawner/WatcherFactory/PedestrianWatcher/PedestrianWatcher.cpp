@@ -32,6 +32,18 @@ void PedestrianWatcher::processFrame()
     }
 }
 
+void PedestrianWatcher::idle()
+{
+    if(currentMode == RenderMode::GUI)
+    {
+        gui->idle();
+    }
+    else if(currentMode == RenderMode::HEADLESS)
+    {
+        headless->idle();
+    }
+}
+
 int PedestrianWatcher::getInstanceCount()
 {
     if(currentMode == RenderMode::GUI)
@@ -44,4 +56,18 @@ int PedestrianWatcher::getInstanceCount()
     }
 
     return -1;
-}
\ No newline at end of file
+}
+
+bool PedestrianWatcher::isStreamDegraded()
+{
+    if(currentMode == RenderMode::GUI)
+    {
+        return gui->isStreamDegraded();
+    }
+    else if(currentMode == RenderMode::HEADLESS)
+    {
+        return headless->isStreamDegraded();
+    }
+
+    return false;
+}
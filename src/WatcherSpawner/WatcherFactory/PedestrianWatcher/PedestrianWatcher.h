@@ -13,7 +13,9 @@ public:
                const std::string& calibName) override;
 
     void processFrame() override;
+    void idle() override;
     int getInstanceCount() override;
+    bool isStreamDegraded() override;
 
 private:
     Gui* gui;
@@ -16,6 +16,12 @@ void VehicleGui::initialize(const std::string& streamName,
     laneLength = videoStreamer.getLaneLength();
     laneWidth = videoStreamer.getLaneWidth();
     segModel = videoStreamer.getSegModel();
+    processingScale = videoStreamer.getProcessingScale();
+    framePacer.initialize(videoStreamer.getPacingMode(),
+                          videoStreamer.getFPS());
+
+    cv::Mat& inputFrame = framePool.getFrame(FrameSlot::INPUT);
+    cv::Mat& warpedFrame = framePool.getFrame(FrameSlot::ROI);
 
     videoStreamer.constructStreamWindow(streamWindow);
     videoStreamer.initializePerspectiveTransform(inputFrame, warpPerspective);
@@ -24,6 +30,7 @@ void VehicleGui::initialize(const std::string& streamName,
     // // If you want to use the yaml config file, use the methods below:
     // pipeDirector.savePipelineConfig(pipeBuilder, calibName);
     pipeDirector.loadPipelineConfig(pipeBuilder, calibName);
+    PipelineDirector::scalePipeline(pipeBuilder, processingScale);
 
     // // Commented out because Trackbar gets confusing with forked processes.
     // // To show Trackbar, be sure to only spawn one process then do the following:
@@ -39,6 +46,43 @@ void VehicleGui::initialize(const std::string& streamName,
     hullDetector.initDetectionBoundaries(warpedFrame);
     hullTracker.initExitBoundaryLine(hullDetector.getEndDetectionLine());
 
+    // contours outside the band are dropped anyway, the margin keeps the
+    // kernel halos and the vehicles crossing the boundaries intact
+    detectionBand = cv::Rect(cv::Point(), warpedFrame.size());
+    if(videoStreamer.isDetectionBandCrop())
+    {
+        int marginRows = FusedPipeline::getPipelineHaloRows(pipeBuilder) +
+                         warpedFrame.rows *
+                             videoStreamer.getDetectionBandMargin() / 100;
+        detectionBand =
+            hullDetector.getDetectionBand(warpedFrame.size(), marginRows);
+    }
+
+    // counts the cv::Mat allocations of every frame, process-wide
+    allocationStats = videoStreamer.isAllocationStats();
+    if(allocationStats)
+    {
+        FramePool::installAllocationCounter();
+    }
+
+    // size the remaining stage outputs, so no frame allocates them
+    framePool.reserve(FrameSlot::PROCESS, detectionBand.size(), CV_8UC1);
+    framePool.reserve(FrameSlot::ROI_MASK, warpedFrame.size(), CV_8UC3);
+    framePool.reserve(FrameSlot::DISPLAY, warpedFrame.size(), CV_8UC3);
+
+    // the thresholds are in native resolution pixels
+    hullDetector.setProcessingScale(processingScale);
+    hullTracker.setProcessingScale(processingScale);
+
+    // the tracked hulls are drawn, labelled blobs need their hull points
+    hullDetector.setComponentLabelling(videoStreamer.isComponentLabelling());
+    hullDetector.setBuildHullPoints(true);
+    hullTracker.setKeepHullPoints(true);
+
+    hullTracker.setMatching(videoStreamer.isGlobalMatching()
+                                ? TrackMatching::GLOBAL
+                                : TrackMatching::FIRST_FIT);
+
     // std::cout << "Press Escape to exit Trackbar loop.\n";
     // while(videoStreamer.applyFrameRoi(inputFrame, warpedFrame, warpPerspective))
     // {
@@ -57,12 +101,19 @@ void VehicleGui::initialize(const std::string& streamName,
 
 void VehicleGui::display()
 {
-    if(!videoStreamer.applyFrameRoi(inputFrame, warpedFrame, warpPerspective))
+    // the tracking pipeline only needs luma, YOLO needs BGR
+    videoStreamer.setLumaOnly(currentTrafficState == TrafficState::GREEN_PHASE);
+    framePool.beginFrame();
+
+    if(!videoStreamer.applyFrameRoi(framePool.getFrame(FrameSlot::INPUT),
+                                    framePool.getFrame(FrameSlot::ROI),
+                                    warpPerspective))
         return;
 
     if(!isTracking)
     {
         fpsHelper.startSample();
+        framePacer.reset();
         isTracking = true;
     }
 
@@ -70,9 +121,16 @@ void VehicleGui::display()
         ? processTrackingState()
         : processSegmentationState(); // we only process YOLO result for gui
 
+    framePool.endFrame();
+
     cv::waitKey(1); // needed for imshow
 }
 
+void VehicleGui::idle()
+{
+    videoStreamer.drainStream();
+}
+
 float VehicleGui::getTrafficDensity()
 {
     float density = 0;
@@ -89,10 +147,24 @@ float VehicleGui::getTrafficDensity()
 
     else if(currentTrafficState == TrafficState::RED_PHASE)
     {
-        float totalArea = segmentation.getWhiteArea(warpedMask);
+        // in native resolution pixels, same as the tracker area
+        const cv::Mat& warpedMask = framePool.getFrame(FrameSlot::ROI_MASK);
+        float totalArea = segmentation.getWhiteArea(warpedMask) /
+                          (processingScale * processingScale);
         density = totalArea / (laneLength * laneWidth);
     }
 
+    if(allocationStats)
+    {
+        std::cout << framePool.getAllocationReport();
+        framePool.resetAllocationStats();
+    }
+
+    if(videoStreamer.isThreadedCapture())
+    {
+        std::cout << videoStreamer.getCaptureReport();
+    }
+
     isTracking = false;
 
     return density;
@@ -117,29 +189,47 @@ int VehicleGui::getInstanceCount()
 
 void VehicleGui::processTrackingState()
 {
-    warpedFrame.copyTo(processFrame);
-    pipeBuilder.process(processFrame);
+    framePacer.waitFrameDeadline(videoStreamer.getFrameTimestamp());
+
+    const cv::Mat& warpedFrame = framePool.getFrame(FrameSlot::ROI);
+
+    // the first step writes straight into the pooled buffer, no copy
+    cv::Mat& processFrame = framePool.getFrame(FrameSlot::PROCESS);
+    pipeBuilder.process(warpedFrame(detectionBand), processFrame);
     // pipeBuilder.processDebugStack(processFrame);
 
-    std::vector<std::vector<cv::Point>> hulls;
-    hullDetector.getHulls(processFrame, hulls);
-    hullTracker.update(hulls);
+    hullDetector.getBlobs(processFrame, blobs, detectionBand.tl());
+    hullTracker.update(blobs);
+
+    // draw on a separate buffer, so the warp output keeps its format
+    // (luma-only capture is converted back only for the colored drawings)
+    cv::Mat& displayFrame = framePool.getFrame(FrameSlot::DISPLAY);
+    if(warpedFrame.channels() == 1)
+    {
+        cv::cvtColor(warpedFrame, displayFrame, cv::COLOR_GRAY2BGR);
+    }
+    else
+    {
+        warpedFrame.copyTo(displayFrame);
+    }
 
-    hullTracker.drawTrackedHulls(warpedFrame);
-    hullTracker.drawLanesInfo(warpedFrame, laneLength, laneWidth);
-    hullDetector.drawLengthBoundaries(warpedFrame);
+    hullTracker.drawTrackedHulls(displayFrame);
+    hullTracker.drawLanesInfo(displayFrame, laneLength, laneWidth);
+    hullDetector.drawLengthBoundaries(displayFrame);
 
     fpsHelper.avgFps();
-    fpsHelper.displayFps(warpedFrame);
+    fpsHelper.displayFps(displayFrame);
 
-    cv::imshow(streamWindow, warpedFrame);
-    cv::waitKey(30);
+    cv::imshow(streamWindow, displayFrame);
 }
 
 void VehicleGui::processSegmentationState()
 {
-    cv::Mat segMask = segmentation.generateMask(inputFrame);
-    warpedMask = videoStreamer.applyPerspective(segMask, warpPerspective);
+    cv::Mat segMask =
+        segmentation.generateMask(framePool.getFrame(FrameSlot::INPUT));
+
+    cv::Mat& warpedMask = framePool.getFrame(FrameSlot::ROI_MASK);
+    videoStreamer.applyPerspective(segMask, warpedMask, warpPerspective);
 
     cv::imshow(streamWindow + " segMask", warpedMask);
     // cv::waitKey(0);
@@ -176,3 +266,13 @@ float VehicleGui::getAverageSpeed()
     // Default speed when not in GREEN_PHASE
     return avgSpeed;
 }
+
+bool VehicleGui::isStreamDegraded()
+{
+    return videoStreamer.isStreamDegraded();
+}
+
+bool VehicleGui::isStreamEnded()
+{
+    return videoStreamer.isStreamEnded();
+}
@@ -5,6 +5,9 @@
 #include <opencv2/opencv.hpp>
 
 #include "FPSHelper.h"
+#include "FramePacer.h"
+#include "FramePool.h"
+#include "FusedPipeline.h"
 #include "HullDetector.h"
 #include "HullTracker.h"
 #include "PipelineBuilder.h"
@@ -23,15 +26,19 @@ public:
                     const std::string& calibName) override;
 
     void display() override;
+    void idle() override;
     float getTrafficDensity() override;
     int getInstanceCount() override;
     std::unordered_map<std::string, int> getVehicleTypeAndCount() override;
     float getAverageSpeed() override;
+    bool isStreamDegraded() override;
+    bool isStreamEnded() override;
 
 private:
     VideoStreamer videoStreamer;
     WarpPerspective warpPerspective;
     FPSHelper fpsHelper;
+    FramePacer framePacer;
 
     PipelineBuilder pipeBuilder;
     PipelineDirector pipeDirector;
@@ -39,18 +46,23 @@ private:
     HullDetector hullDetector;
     HullTracker hullTracker;
 
+    // rows of the ROI that are preprocessed, the whole ROI unless cropped
+    cv::Rect detectionBand;
+
     SegmentationMask segmentation;
 
-    cv::Mat inputFrame;
-    cv::Mat warpedFrame;
-    cv::Mat processFrame;
-    cv::Mat warpedMask;
+    FramePool framePool;
+    bool allocationStats = false;
+
+    // blobs of the current frame, reused so detection does not allocate
+    std::vector<HullBlob> blobs;
 
     std::string streamWindow;
     std::string segModel;
 
     int laneLength;
     int laneWidth;
+    double processingScale;
 
     void processTrackingState();
     void processSegmentationState();
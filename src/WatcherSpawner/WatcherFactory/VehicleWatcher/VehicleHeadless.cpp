@@ -1,6 +1,22 @@
 #include "VehicleHeadless.h"
-#include <chrono>
-#include <thread>
+#include <iomanip>
+#include <sstream>
+
+VehicleHeadless::VehicleHeadless()
+    : motionGating(false)
+    , stepTiming(false)
+    , allocationStats(false)
+    , pipelinedProcessing(false)
+    , exitAtStreamEnd(true)
+    , pipelineRunning(false)
+    , captureRunning(false)
+    , nextTrackedSequence(0)
+{}
+
+VehicleHeadless::~VehicleHeadless()
+{
+    stopPipeline();
+}
 
 void VehicleHeadless::initialize(const std::string& streamName,
                                  const std::string& calibName)
@@ -16,16 +32,88 @@ void VehicleHeadless::initialize(const std::string& streamName,
     laneLength = videoStreamer.getLaneLength();
     laneWidth = videoStreamer.getLaneWidth();
     segModel = videoStreamer.getSegModel();
-    sleepTime = 1000 / videoStreamer.getFPS();
+    processingScale = videoStreamer.getProcessingScale();
+    framePacer.initialize(videoStreamer.getPacingMode(),
+                          videoStreamer.getFPS());
+
+    motionGating = videoStreamer.isMotionGating();
+    motionGate.initialize(videoStreamer.getMotionGateInterval(),
+                          videoStreamer.getFPS());
+
+    cv::Mat& inputFrame = framePool.getFrame(FrameSlot::INPUT);
+    cv::Mat& warpedFrame = framePool.getFrame(FrameSlot::ROI);
 
     videoStreamer.initializePerspectiveTransform(inputFrame, warpPerspective);
     pipeDirector.loadPipelineConfig(pipeBuilder, calibName);
+    PipelineDirector::scalePipeline(pipeBuilder, processingScale);
+    fusedPipeline.compile(pipeBuilder);
+    fusedPipeline.setParallel(videoStreamer.isParallelPreprocess());
+
+    // specialized at compile time if the config is a known one, but then
+    // every step runs on the whole frame, on one core
+    if(!videoStreamer.isParallelPreprocess())
+    {
+        staticPipeline = PipelineDirector::createStaticPipeline(pipeBuilder);
+    }
+
+    stepTiming = videoStreamer.isStepTiming();
+    StepTimings* timings = stepTiming ? &stepTimings : nullptr;
+    fusedPipeline.setTimings(timings);
+    if(staticPipeline)
+    {
+        staticPipeline->setTimings(timings);
+    }
+
+    pipelinedProcessing = videoStreamer.isPipelinedProcessing();
+
+    // the capture stage thread must not exit the process, see process
+    exitAtStreamEnd = videoStreamer.isExitAtStreamEnd();
+    videoStreamer.setExitAtStreamEnd(exitAtStreamEnd && !pipelinedProcessing);
+
+    size_t queueDepth = videoStreamer.getPipelineQueueDepth();
+    warpedQueue.reset(queueDepth);
+    preprocessedQueue.reset(queueDepth);
+    hullQueue.reset(queueDepth);
 
     videoStreamer.applyFrameRoi(inputFrame, warpedFrame, warpPerspective);
 
     hullDetector.initDetectionBoundaries(warpedFrame);
     hullTracker.initExitBoundaryLine(hullDetector.getEndDetectionLine());
 
+    // contours outside the band are dropped anyway, the margin keeps the
+    // kernel halos and the vehicles crossing the boundaries intact
+    detectionBand = cv::Rect(cv::Point(), warpedFrame.size());
+    if(videoStreamer.isDetectionBandCrop())
+    {
+        int marginRows = FusedPipeline::getPipelineHaloRows(pipeBuilder) +
+                         warpedFrame.rows *
+                             videoStreamer.getDetectionBandMargin() / 100;
+        detectionBand =
+            hullDetector.getDetectionBand(warpedFrame.size(), marginRows);
+    }
+
+    // counts the cv::Mat allocations of every frame, process-wide
+    allocationStats = videoStreamer.isAllocationStats();
+    if(allocationStats)
+    {
+        FramePool::installAllocationCounter();
+    }
+
+    // size the remaining stage outputs, so no frame allocates them
+    framePool.reserve(FrameSlot::PROCESS, detectionBand.size(), CV_8UC1);
+    framePool.reserve(FrameSlot::ROI_MASK, warpedFrame.size(), CV_8UC3);
+
+    // the thresholds are in native resolution pixels
+    hullDetector.setProcessingScale(processingScale);
+    hullTracker.setProcessingScale(processingScale);
+
+    // nothing is drawn, the blobs go to the tracker without hull points
+    hullDetector.setComponentLabelling(videoStreamer.isComponentLabelling());
+
+    hullTracker.setMatching(videoStreamer.isGlobalMatching()
+                                ? TrackMatching::GLOBAL
+                                : TrackMatching::FIRST_FIT);
+
     std::unique_ptr<ISegmentationStrategy> strategy =
         std::make_unique<VehicleSegmentationStrategy>();
     segmentation.initializeModel(segModel, std::move(strategy));
@@ -35,18 +123,66 @@ void VehicleHeadless::initialize(const std::string& streamName,
 
 void VehicleHeadless::process()
 {
-    if(!videoStreamer.applyFrameRoi(inputFrame, warpedFrame, warpPerspective))
+    // the tracking pipeline only needs luma, YOLO needs BGR
+    videoStreamer.setLumaOnly(currentTrafficState == TrafficState::GREEN_PHASE);
+
+    if(pipelinedProcessing &&
+       currentTrafficState == TrafficState::GREEN_PHASE)
+    {
+        if(!isTracking)
+        {
+            stopPipeline(); // tracks the frames left from a previous run
+            fpsHelper.startSample();
+            framePacer.reset();
+            motionGate.reset();
+            isTracking = true;
+        }
+
+        startPipeline();
+        trackPipelinedFrame();
+
+        // the capture stage only finishes on its own at the end of the file,
+        // exit as the serial mode does, once the stages are joined
+        if(getStageFinished(PipelineStage::CAPTURE))
+        {
+            stopPipeline();
+            if(!exitAtStreamEnd)
+                return;
+
+            std::cerr << "Too many missing frames. Exiting...\n";
+            exit(EXIT_FAILURE);
+        }
+        return;
+    }
+
+    // the stages own the stream and pool frames while running
+    stopPipeline();
+    framePool.beginFrame();
+
+    if(!videoStreamer.applyFrameRoi(framePool.getFrame(FrameSlot::INPUT),
+                                    framePool.getFrame(FrameSlot::ROI),
+                                    warpPerspective))
         return;
 
     if(!isTracking)
     {
         fpsHelper.startSample();
+        framePacer.reset();
+        motionGate.reset();
         isTracking = true;
     }
 
     (currentTrafficState == TrafficState::GREEN_PHASE)
         ? processTrackingState()
         : processSegmentationState();
+
+    framePool.endFrame();
+}
+
+void VehicleHeadless::idle()
+{
+    stopPipeline();
+    videoStreamer.drainStream();
 }
 
 float VehicleHeadless::getTrafficDensity()
@@ -55,6 +191,14 @@ float VehicleHeadless::getTrafficDensity()
 
     if(currentTrafficState == TrafficState::GREEN_PHASE)
     {
+        // queue depths before they are drained
+        if(pipelineRunning)
+        {
+            std::cout << getPipelineReport();
+        }
+
+        stopPipeline();
+
         float totalTime = fpsHelper.endSample() / 1000;
         float flow = hullTracker.getTotalHullArea() / totalTime;
         float average = hullTracker.getAveragedSpeed();
@@ -62,14 +206,35 @@ float VehicleHeadless::getTrafficDensity()
         density = (flow == 0) ? 0 : flow / (average * laneWidth);
 
         hullTracker.resetTrackerVariables();
+
+        if(stepTiming)
+        {
+            std::cout << "Preprocessing step timings:\n"
+                      << stepTimings.getReport();
+            stepTimings.reset();
+        }
     }
 
     else if(currentTrafficState == TrafficState::RED_PHASE)
     {
-        float totalArea = segmentation.getWhiteArea(warpedMask);
+        // in native resolution pixels, same as the tracker area
+        const cv::Mat& warpedMask = framePool.getFrame(FrameSlot::ROI_MASK);
+        float totalArea = segmentation.getWhiteArea(warpedMask) /
+                          (processingScale * processingScale);
         density = totalArea / (laneLength * laneWidth);
     }
 
+    if(allocationStats)
+    {
+        std::cout << framePool.getAllocationReport();
+        framePool.resetAllocationStats();
+    }
+
+    if(videoStreamer.isThreadedCapture())
+    {
+        std::cout << videoStreamer.getCaptureReport();
+    }
+
     isTracking = false;
 
     return density;
@@ -92,23 +257,45 @@ int VehicleHeadless::getInstanceCount()
     return count;
 }
 
+void VehicleHeadless::preprocessFrame(const cv::Mat& warpedFrame,
+                                      cv::Mat& processFrame)
+{
+    // a row range of the ROI stays continuous, no copy
+    const cv::Mat bandFrame = warpedFrame(detectionBand);
+
+    if(staticPipeline)
+    {
+        staticPipeline->process(bandFrame, processFrame);
+        return;
+    }
+
+    // fused band by band
+    fusedPipeline.process(bandFrame, processFrame);
+}
+
 void VehicleHeadless::processTrackingState()
 {
-    warpedFrame.copyTo(processFrame);
-    pipeBuilder.process(processFrame);
+    framePacer.waitFrameDeadline(videoStreamer.getFrameTimestamp());
 
-    std::vector<std::vector<cv::Point>> hulls;
-    hullDetector.getHulls(processFrame, hulls);
-    hullTracker.update(hulls);
+    const cv::Mat& warpedFrame = framePool.getFrame(FrameSlot::ROI);
+    if(motionGating && !motionGate.update(warpedFrame))
+        return;
+
+    // straight into the pooled buffer, no copy
+    cv::Mat& processFrame = framePool.getFrame(FrameSlot::PROCESS);
+    preprocessFrame(warpedFrame, processFrame);
 
-    std::this_thread::sleep_for(std::chrono::milliseconds(sleepTime));
+    hullDetector.getBlobs(processFrame, blobs, detectionBand.tl());
+    hullTracker.update(blobs);
 }
 
 void VehicleHeadless::processSegmentationState()
 {
-    cv::Mat segMask = segmentation.generateMask(inputFrame);
+    cv::Mat segMask =
+        segmentation.generateMask(framePool.getFrame(FrameSlot::INPUT));
     // still need to update warpedMask for getWhiteArea method
-    warpedMask = videoStreamer.applyPerspective(segMask, warpPerspective);
+    videoStreamer.applyPerspective(
+        segMask, framePool.getFrame(FrameSlot::ROI_MASK), warpPerspective);
 }
 
 std::unordered_map<std::string, int> VehicleHeadless::getVehicleTypeAndCount()
@@ -141,4 +328,270 @@ float VehicleHeadless::getAverageSpeed()
 
     // Default speed when not in GREEN_PHASE
     return avgSpeed;
-}
\ No newline at end of file
+}
+
+bool VehicleHeadless::isStreamDegraded()
+{
+    return videoStreamer.isStreamDegraded() ||
+           (motionGating && motionGate.isFeedFrozen());
+}
+
+bool VehicleHeadless::isStreamEnded()
+{
+    // the capture stage owns the stream while the pipeline runs
+    if(pipelineRunning)
+        return getStageFinished(PipelineStage::CAPTURE);
+
+    return videoStreamer.isStreamEnded();
+}
+
+void VehicleHeadless::startPipeline()
+{
+    if(pipelineRunning)
+        return;
+
+    warpedQueue.reset(warpedQueue.capacity());
+    preprocessedQueue.reset(preprocessedQueue.capacity());
+    hullQueue.reset(hullQueue.capacity());
+    nextTrackedSequence = 0;
+
+    for(auto& timer : stageTimers)
+    {
+        timer.busyUs = 0;
+        timer.totalUs = 0;
+    }
+
+    for(auto& finished : stageFinished)
+    {
+        finished = false;
+    }
+
+    pipelineRunning = true;
+    captureRunning = true;
+
+    stageThreads[static_cast<size_t>(PipelineStage::CAPTURE)] =
+        std::thread(&VehicleHeadless::captureStage, this);
+
+    stageThreads[static_cast<size_t>(PipelineStage::PREPROCESS)] =
+        std::thread([this] {
+            runStage(PipelineStage::PREPROCESS,
+                     warpedQueue,
+                     preprocessedQueue,
+                     [this](const StageFrame& warped, StageFrame& processed) {
+                         preprocessFrame(warped.frame, processed.frame);
+                     });
+        });
+
+    stageThreads[static_cast<size_t>(PipelineStage::DETECT)] =
+        std::thread([this] {
+            runStage(PipelineStage::DETECT,
+                     preprocessedQueue,
+                     hullQueue,
+                     [this](const StageFrame& processed, StageBlobs& detected) {
+                         hullDetector.getBlobs(processed.frame,
+                                               detected.blobs,
+                                               detectionBand.tl());
+                     });
+        });
+}
+
+void VehicleHeadless::stopPipeline()
+{
+    if(!pipelineRunning)
+        return;
+
+    // no new frames, but the ones already captured still reach the tracker,
+    // as every frame read in the serial mode does, so no count is lost
+    captureRunning = false;
+    while(!getStageFinished(PipelineStage::DETECT) || hullQueue.size() > 0)
+    {
+        trackPipelinedFrame();
+    }
+
+    for(auto& thread : stageThreads)
+    {
+        if(thread.joinable())
+        {
+            thread.join();
+        }
+    }
+
+    pipelineRunning = false;
+}
+
+void VehicleHeadless::captureStage()
+{
+    StageTimer& timer = getStageTimer(PipelineStage::CAPTURE);
+    cv::Mat& inputFrame = framePool.getFrame(FrameSlot::INPUT);
+    uint64_t sequence = 0;
+
+    while(captureRunning)
+    {
+        Clock::time_point iterationStart = Clock::now();
+
+        StageFrame* warped = warpedQueue.acquireWriteSlot();
+        if(warped == nullptr)
+        {
+            std::this_thread::sleep_for(
+                std::chrono::microseconds(QUEUE_WAIT_US));
+
+            Clock::time_point now = Clock::now();
+            recordStageTime(timer, iterationStart, now, now);
+            continue;
+        }
+
+        Clock::time_point workStart = Clock::now();
+        bool hasFrame = videoStreamer.applyFrameRoi(
+            inputFrame, warped->frame, warpPerspective);
+        Clock::time_point workEnd = Clock::now();
+
+        if(!hasFrame && videoStreamer.isStreamEnded())
+            break;
+
+        if(hasFrame)
+        {
+            // paced before the frame is handed on, as in the serial mode
+            framePacer.waitFrameDeadline(videoStreamer.getFrameTimestamp());
+        }
+
+        // a skipped frame leaves the slot to the next one
+        if(hasFrame && (!motionGating || motionGate.update(warped->frame)))
+        {
+            warped->sequence = sequence++;
+            warpedQueue.commitWrite();
+        }
+
+        recordStageTime(timer, iterationStart, workStart, workEnd);
+    }
+
+    getStageFinished(PipelineStage::CAPTURE) = true;
+}
+
+template<typename Input, typename Output, typename Work>
+void VehicleHeadless::runStage(PipelineStage stage,
+                               SpscQueue<Input>& inputQueue,
+                               SpscQueue<Output>& outputQueue,
+                               Work work)
+{
+    // the stages are in pipeline order, the input is the previous one's
+    auto previous = static_cast<PipelineStage>(static_cast<size_t>(stage) - 1);
+    const std::atomic<bool>& inputFinished = getStageFinished(previous);
+    StageTimer& timer = getStageTimer(stage);
+
+    // runs until the previous stage finished and its frames are processed
+    while(true)
+    {
+        Clock::time_point iterationStart = Clock::now();
+
+        // checked before the queue, the previous stage commits its last
+        // frame before finishing
+        bool noMoreInput = inputFinished;
+        Input* input = inputQueue.peekReadSlot();
+        if(input == nullptr && noMoreInput)
+            break;
+
+        Output* output = outputQueue.acquireWriteSlot();
+        if(input == nullptr || output == nullptr)
+        {
+            std::this_thread::sleep_for(
+                std::chrono::microseconds(QUEUE_WAIT_US));
+
+            Clock::time_point now = Clock::now();
+            recordStageTime(timer, iterationStart, now, now);
+            continue;
+        }
+
+        Clock::time_point workStart = Clock::now();
+        work(*input, *output);
+        Clock::time_point workEnd = Clock::now();
+
+        output->sequence = input->sequence;
+        outputQueue.commitWrite();
+        inputQueue.commitRead();
+
+        recordStageTime(timer, iterationStart, workStart, workEnd);
+    }
+
+    getStageFinished(stage) = true;
+}
+
+void VehicleHeadless::trackPipelinedFrame()
+{
+    StageBlobs* detected = hullQueue.peekReadSlot();
+    if(detected == nullptr)
+    {
+        std::this_thread::sleep_for(std::chrono::microseconds(QUEUE_WAIT_US));
+        return;
+    }
+
+    // the queues keep the order and no stage drops a frame (still frames
+    // are skipped before being numbered), a gap is a bug
+    CV_Assert(detected->sequence == nextTrackedSequence);
+
+    ++nextTrackedSequence;
+    hullTracker.update(detected->blobs);
+    hullQueue.commitRead();
+}
+
+void VehicleHeadless::recordStageTime(StageTimer& timer,
+                                      Clock::time_point iterationStart,
+                                      Clock::time_point workStart,
+                                      Clock::time_point workEnd)
+{
+    using std::chrono::duration_cast;
+    using std::chrono::microseconds;
+
+    timer.busyUs += duration_cast<microseconds>(workEnd - workStart).count();
+    timer.totalUs +=
+        duration_cast<microseconds>(Clock::now() - iterationStart).count();
+}
+
+VehicleHeadless::StageTimer&
+VehicleHeadless::getStageTimer(PipelineStage stage)
+{
+    return stageTimers[static_cast<size_t>(stage)];
+}
+
+std::atomic<bool>& VehicleHeadless::getStageFinished(PipelineStage stage)
+{
+    return stageFinished[static_cast<size_t>(stage)];
+}
+
+double VehicleHeadless::getOccupancy(PipelineStage stage) const
+{
+    const StageTimer& timer = stageTimers[static_cast<size_t>(stage)];
+    uint64_t totalUs = timer.totalUs;
+
+    return (totalUs == 0) ? 0.0 : static_cast<double>(timer.busyUs) / totalUs;
+}
+
+PipelineStats VehicleHeadless::getPipelineStats() const
+{
+    PipelineStats stats;
+    stats.queueDepth = warpedQueue.capacity();
+    stats.warpedFrames = warpedQueue.size();
+    stats.preprocessedFrames = preprocessedQueue.size();
+    stats.detectedFrames = hullQueue.size();
+    stats.captureOccupancy = getOccupancy(PipelineStage::CAPTURE);
+    stats.preprocessOccupancy = getOccupancy(PipelineStage::PREPROCESS);
+    stats.detectOccupancy = getOccupancy(PipelineStage::DETECT);
+
+    return stats;
+}
+
+std::string VehicleHeadless::getPipelineReport() const
+{
+    PipelineStats stats = getPipelineStats();
+
+    std::ostringstream report;
+    report << std::fixed << std::setprecision(2)
+           << "Pipeline queues (of " << stats.queueDepth
+           << "): warped=" << stats.warpedFrames
+           << " preprocessed=" << stats.preprocessedFrames
+           << " detected=" << stats.detectedFrames << "\n"
+           << "Pipeline occupancy: capture=" << stats.captureOccupancy
+           << " preprocess=" << stats.preprocessOccupancy
+           << " detect=" << stats.detectOccupancy << "\n";
+
+    return report.str();
+}
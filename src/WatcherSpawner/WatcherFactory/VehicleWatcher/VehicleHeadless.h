@@ -2,60 +2,174 @@
 #define VEHICLE_HEADLESS_H
 
 #include "Headless.h"
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <opencv2/opencv.hpp>
+#include <string>
+#include <thread>
 
 #include "FPSHelper.h"
+#include "FramePacer.h"
+#include "FramePool.h"
+#include "FusedPipeline.h"
 #include "HullDetector.h"
 #include "HullTracker.h"
+#include "MotionGate.h"
 #include "PipelineBuilder.h"
 #include "PipelineDirector.h"
 #include "SegmentationMask.h"
+#include "SpscQueue.h"
 #include "TrafficState.h"
 #include "VehicleSegmentationStrategy.h"
 #include "VideoStreamer.h"
 #include "WarpPerspective.h"
 
+/**
+ * @brief Queue depth and occupancy of the pipelined watcher stages.
+ * The queued frame counts are snapshots, the occupancy of a stage is the
+ * fraction of time its thread spent processing rather than waiting.
+ */
+struct PipelineStats
+{
+    size_t queueDepth = 0;
+    size_t warpedFrames = 0;
+    size_t preprocessedFrames = 0;
+    size_t detectedFrames = 0;
+    double captureOccupancy = 0;
+    double preprocessOccupancy = 0;
+    double detectOccupancy = 0;
+};
+
 class VehicleHeadless : public Headless
 {
 public:
+    VehicleHeadless();
+    ~VehicleHeadless();
+
     void initialize(const std::string& streamName,
                     const std::string& calibName) override;
 
     void process() override;
+    void idle() override;
     float getTrafficDensity() override;
     int getInstanceCount() override;
     std::unordered_map<std::string, int> getVehicleTypeAndCount() override;
     float getAverageSpeed() override;
+    bool isStreamDegraded() override;
+    bool isStreamEnded() override;
+
 
 private:
     VideoStreamer videoStreamer;
     WarpPerspective warpPerspective;
     FPSHelper fpsHelper;
+    FramePacer framePacer;
+
+    // frames without motion skip preprocessing, detection and tracking
+    bool motionGating;
+    MotionGate motionGate;
 
     PipelineBuilder pipeBuilder;
     PipelineDirector pipeDirector;
+    FusedPipeline fusedPipeline;
+    std::unique_ptr<IStaticPipeline> staticPipeline;
+
+    // per step latencies of the preprocessing, reported per green sample
+    bool stepTiming;
+    StepTimings stepTimings;
 
     HullDetector hullDetector;
     HullTracker hullTracker;
 
+    // rows of the ROI that are preprocessed, the whole ROI unless cropped
+    cv::Rect detectionBand;
+
     SegmentationMask segmentation;
 
-    cv::Mat inputFrame;
-    cv::Mat warpedFrame;
-    cv::Mat processFrame;
-    cv::Mat warpedMask;
+    FramePool framePool;
+    bool allocationStats;
+
+    // blobs of the current frame, reused so detection does not allocate
+    std::vector<HullBlob> blobs;
 
     std::string segModel;
 
     int laneLength;
     int laneWidth;
+    double processingScale;
 
-    int sleepTime;
-
+    void preprocessFrame(const cv::Mat& warpedFrame, cv::Mat& processFrame);
     void processTrackingState();
     void processSegmentationState();
 
     bool isTracking;
+
+    // pipelined mode, capture/warp, preprocessing and hull detection each
+    // run on a thread, the tracker stays on the watcher thread
+    using Clock = std::chrono::steady_clock;
+    static constexpr int QUEUE_WAIT_US = 200;
+
+    struct StageFrame
+    {
+        uint64_t sequence = 0;
+        cv::Mat frame;
+    };
+
+    struct StageBlobs
+    {
+        uint64_t sequence = 0;
+        std::vector<HullBlob> blobs;
+    };
+
+    struct StageTimer
+    {
+        std::atomic<uint64_t> busyUs{0};
+        std::atomic<uint64_t> totalUs{0};
+    };
+
+    enum class PipelineStage
+    {
+        CAPTURE,
+        PREPROCESS,
+        DETECT,
+        COUNT
+    };
+    static constexpr size_t STAGE_COUNT =
+        static_cast<size_t>(PipelineStage::COUNT);
+
+    bool pipelinedProcessing;
+    bool exitAtStreamEnd;
+    std::atomic<bool> pipelineRunning;
+    std::atomic<bool> captureRunning;
+    std::array<std::atomic<bool>, STAGE_COUNT> stageFinished;
+    std::array<std::thread, STAGE_COUNT> stageThreads;
+    std::array<StageTimer, STAGE_COUNT> stageTimers;
+
+    SpscQueue<StageFrame> warpedQueue;
+    SpscQueue<StageFrame> preprocessedQueue;
+    SpscQueue<StageBlobs> hullQueue;
+    uint64_t nextTrackedSequence;
+
+    void startPipeline();
+    void stopPipeline();
+    void captureStage();
+    template<typename Input, typename Output, typename Work>
+    void runStage(PipelineStage stage,
+                  SpscQueue<Input>& inputQueue,
+                  SpscQueue<Output>& outputQueue,
+                  Work work);
+    void trackPipelinedFrame();
+
+    static void recordStageTime(StageTimer& timer,
+                                Clock::time_point iterationStart,
+                                Clock::time_point workStart,
+                                Clock::time_point workEnd);
+    StageTimer& getStageTimer(PipelineStage stage);
+    std::atomic<bool>& getStageFinished(PipelineStage stage);
+    double getOccupancy(PipelineStage stage) const;
+    PipelineStats getPipelineStats() const;
+    std::string getPipelineReport() const;
 };
 
 #endif
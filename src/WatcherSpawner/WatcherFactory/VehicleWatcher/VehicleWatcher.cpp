@@ -32,6 +32,18 @@ void VehicleWatcher::processFrame()
     }
 }
 
+void VehicleWatcher::idle()
+{
+    if(currentMode == RenderMode::GUI)
+    {
+        gui->idle();
+    }
+    else if(currentMode == RenderMode::HEADLESS)
+    {
+        headless->idle();
+    }
+}
+
 void VehicleWatcher::setCurrentTrafficState(TrafficState state)
 {
     if(currentMode == RenderMode::GUI)
@@ -99,4 +111,32 @@ float VehicleWatcher::getAverageSpeed()
     }
 
     return -1;
-}
\ No newline at end of file
+}
+
+bool VehicleWatcher::isStreamDegraded()
+{
+    if(currentMode == RenderMode::GUI)
+    {
+        return gui->isStreamDegraded();
+    }
+    else if(currentMode == RenderMode::HEADLESS)
+    {
+        return headless->isStreamDegraded();
+    }
+
+    return false;
+}
+
+bool VehicleWatcher::isStreamEnded()
+{
+    if(currentMode == RenderMode::GUI)
+    {
+        return gui->isStreamEnded();
+    }
+    else if(currentMode == RenderMode::HEADLESS)
+    {
+        return headless->isStreamEnded();
+    }
+
+    return false;
+}
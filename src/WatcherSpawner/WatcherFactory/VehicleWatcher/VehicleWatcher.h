@@ -13,12 +13,15 @@ public:
                const std::string& calibName) override;
 
     void processFrame() override;
+    void idle() override;
 
     void setCurrentTrafficState(TrafficState state) override;
     float getTrafficDensity() override;
     int getInstanceCount() override;
     std::unordered_map<std::string, int> getVehicleTypeAndCount() override;
     float getAverageSpeed() override;
+    bool isStreamDegraded() override;
+    bool isStreamEnded() override;
 
 private:
     Gui* gui;
@@ -20,6 +20,12 @@ public:
         exit(EXIT_FAILURE);
     }
 
+    virtual void idle()
+    {
+        std::cerr << "This method has no implementation. \nEXITING...\n\n";
+        exit(EXIT_FAILURE);
+    }
+
     void setCurrentTrafficState(TrafficState state)
     {
         currentTrafficState = state;
@@ -49,6 +55,18 @@ public:
         exit(EXIT_FAILURE);
     }
 
+    virtual bool isStreamDegraded()
+    {
+        std::cerr << "This method has no implementation. \nEXITING...\n\n";
+        exit(EXIT_FAILURE);
+    }
+
+    virtual bool isStreamEnded()
+    {
+        std::cerr << "This method has no implementation. \nEXITING...\n\n";
+        exit(EXIT_FAILURE);
+    }
+
 protected:
     TrafficState currentTrafficState;
 };
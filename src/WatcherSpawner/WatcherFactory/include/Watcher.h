@@ -27,6 +27,12 @@ public:
         exit(EXIT_FAILURE);
     }
 
+    virtual void idle()
+    {
+        std::cerr << "This method has no implementation. \nEXITING...\n\n";
+        exit(EXIT_FAILURE);
+    }
+
     virtual void setCurrentTrafficState(TrafficState state)
     {
         std::cerr << "This method has no implementation. \nEXITING...\n\n";
@@ -56,6 +62,18 @@ public:
         std::cerr << "This method has no implementation. \nEXITING...\n\n";
         exit(EXIT_FAILURE);
     }
+
+    virtual bool isStreamDegraded()
+    {
+        std::cerr << "This method has no implementation. \nEXITING...\n\n";
+        exit(EXIT_FAILURE);
+    }
+
+    virtual bool isStreamEnded()
+    {
+        std::cerr << "This method has no implementation. \nEXITING...\n\n";
+        exit(EXIT_FAILURE);
+    }
 };
 
 #endif
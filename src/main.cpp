@@ -24,6 +24,9 @@ int main(int argc, char* argv[])
         "Verbose mode",
         cxxopts::value<bool>()->default_value("false"))(
         "t,test", "Test mode", cxxopts::value<bool>()->default_value("false"))(
+        "b,bench",
+        "Benchmark mode",
+        cxxopts::value<bool>()->default_value("false"))(
         "j,jconf",
         "Junction config",
         cxxopts::value<std::string>()->default_value("junction_config.yaml"))(
@@ -41,6 +44,7 @@ int main(int argc, char* argv[])
     bool calib = result["calib"].as<bool>();
     bool verbose = result["verbose"].as<bool>();
     bool test = result["test"].as<bool>();
+    bool bench = result["bench"].as<bool>();
     std::string configFile = result["jconf"].as<std::string>();
 
     if(verbose)
@@ -50,7 +54,8 @@ int main(int argc, char* argv[])
         std::cout << "Number of CPU cores: " << cv::getNumberOfCPUs() << "\n";
     }
 
-    TrafficManager trafficManager(configFile, debug, calib, verbose, test);
+    TrafficManager trafficManager(
+        configFile, debug, calib, verbose, test, bench);
     trafficManager.start();
 
     return 0;